@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+
+#include "utility/unistd_compat.hpp"
+#include "dbglog/dbglog.hpp"
+
+#include "block-cache.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace utility { namespace io {
+
+constexpr std::size_t BlockCache::DefaultBlockSize;
+constexpr std::size_t BlockCache::DefaultBudget;
+
+std::size_t BlockCache::BlockKeyHash::operator()(const BlockKey &key) const
+{
+    std::size_t seed(0);
+    const auto combine([&](std::uint64_t value) {
+        seed ^= std::hash<std::uint64_t>()(value)
+            + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    });
+
+    combine(key.file.dev);
+    combine(key.file.ino);
+    combine(key.file.size);
+    combine(key.file.modified);
+    combine(key.file.changed);
+    combine(key.block);
+    return seed;
+}
+
+BlockCache::BlockCache(std::size_t budget, std::size_t blockSize)
+    : blockSize_(std::max(blockSize, std::size_t(512))), budget_(budget)
+{}
+
+const BlockCache::pointer& BlockCache::process()
+{
+    static const pointer cache(std::make_shared<BlockCache>());
+    return cache;
+}
+
+BlockCache::FileKey BlockCache::key(int fd, const fs::path &path)
+{
+    try {
+        return FileKey::from(fd);
+    } catch (const std::system_error &e) {
+        LOG(err2) << "Cannot stat file " << path << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw;
+    }
+}
+
+std::size_t BlockCache::read(int fd, const FileKey &key, char *data
+                             , std::size_t size, std::uint64_t pos
+                             , const fs::path &path)
+{
+    // trim to file size
+    if (pos >= key.size) { return 0; }
+    size = std::min(std::uint64_t(size), key.size - pos);
+
+    std::size_t total(0);
+    while (total < size) {
+        const BlockKey bkey{ key, pos / blockSize_ };
+        const std::size_t offset(pos % blockSize_);
+
+        BlockPointer block;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            block = find(bkey);
+        }
+
+        if (!block) {
+            // load whole block
+            auto loaded(std::make_shared<Block>
+                        (std::min(std::uint64_t(blockSize_)
+                                  , key.size - bkey.block * blockSize_)));
+            std::size_t got(0);
+            while (got < loaded->size()) {
+                const auto bytes
+                    (TEMP_FAILURE_RETRY
+                     (::pread(fd, loaded->data() + got, loaded->size() - got
+                              , bkey.block * blockSize_ + got)));
+                if (bytes == -1) {
+                    std::system_error e(errno, std::system_category());
+                    LOG(err2) << "Cannot read from file " << path << ": <"
+                              << e.code() << ", " << e.what() << ">.";
+                    throw e;
+                }
+                if (!bytes) { break; }
+                got += bytes;
+            }
+
+            // file shrunk under our hands, do not cache
+            if (got < loaded->size()) {
+                loaded->resize(got);
+                block = loaded;
+            } else {
+                block = loaded;
+                std::lock_guard<std::mutex> lock(mutex_);
+                insert(bkey, block);
+            }
+        }
+
+        if (offset >= block->size()) { break; }
+
+        const auto chunk(std::min(size - total, block->size() - offset));
+        std::memcpy(data + total, block->data() + offset, chunk);
+        total += chunk;
+        pos += chunk;
+
+        // short block: end of data
+        if (block->size() < blockSize_) { break; }
+    }
+
+    return total;
+}
+
+BlockCache::BlockPointer BlockCache::find(const BlockKey &key)
+{
+    auto iindex(index_.find(key));
+    if (iindex == index_.end()) {
+        ++stats_.misses;
+        return {};
+    }
+
+    ++stats_.hits;
+    entries_.splice(entries_.end(), entries_, iindex->second);
+    return iindex->second->data;
+}
+
+void BlockCache::insert(const BlockKey &key, const BlockPointer &data)
+{
+    // someone else could have been faster
+    if (index_.find(key) != index_.end()) { return; }
+
+    entries_.push_back(Entry{ key, data });
+    index_[key] = std::prev(entries_.end());
+    stats_.memory += data->size();
+    ++stats_.blocks;
+
+    trim();
+}
+
+void BlockCache::trim()
+{
+    while (!entries_.empty() && (stats_.memory > budget_)) {
+        const auto &entry(entries_.front());
+        stats_.memory -= entry.data->size();
+        --stats_.blocks;
+        ++stats_.evictions;
+        index_.erase(entry.key);
+        entries_.pop_front();
+    }
+}
+
+void BlockCache::budget(std::size_t budget)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = budget;
+    trim();
+}
+
+std::size_t BlockCache::budget() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+void BlockCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    stats_.blocks = stats_.memory = 0;
+}
+
+BlockCache::Statistics BlockCache::statistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} } // namespace utility::io
@@ -0,0 +1,170 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_block_cache_hpp_included_
+#define utility_block_cache_hpp_included_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "filesystem.hpp"
+
+namespace utility { namespace io {
+
+/** Block cache of file data.
+ *
+ *  File data are cached in fixed size blocks (aligned to block size) keyed
+ *  by precise file identity (see utility::FileKey) and block number, i.e.
+ *  different descriptors of the same file share cached blocks and modified
+ *  file never hits stale blocks. Blocks are kept under memory budget, least
+ *  recently used blocks are evicted first.
+ *
+ *  All operations are thread safe. Blocks are read outside of the lock.
+ */
+class BlockCache : boost::noncopyable {
+public:
+    typedef std::shared_ptr<BlockCache> pointer;
+
+    /** Default block size.
+     */
+    static constexpr std::size_t DefaultBlockSize = 1 << 16;
+
+    /** Default budget of process-wide cache.
+     */
+    static constexpr std::size_t DefaultBudget = std::size_t(64) << 20;
+
+    /** File identity, see utility::FileKey.
+     */
+    typedef utility::FileKey FileKey;
+
+    struct Statistics {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+
+        /** Current state.
+         */
+        std::size_t blocks = 0;
+        std::size_t memory = 0;
+    };
+
+    BlockCache(std::size_t budget = DefaultBudget
+               , std::size_t blockSize = DefaultBlockSize);
+
+    /** Process-wide cache instance (created with default budget).
+     */
+    static const pointer& process();
+
+    /** Returns identity of open file. Throws std::system_error on failure.
+     */
+    static FileKey key(int fd, const boost::filesystem::path &path = {});
+
+    /** Reads up to size bytes at given position of given file. Returns
+     *  number of bytes read, less than size only at the end of file.
+     *  Throws std::system_error on failure.
+     *
+     * \param fd file descriptor, used to load missing blocks
+     * \param key file identity (see key())
+     */
+    std::size_t read(int fd, const FileKey &key, char *data
+                     , std::size_t size, std::uint64_t pos
+                     , const boost::filesystem::path &path = {});
+
+    /** Changes memory budget. Evicts blocks if needed.
+     */
+    void budget(std::size_t budget);
+
+    std::size_t budget() const;
+
+    std::size_t blockSize() const { return blockSize_; }
+
+    /** Drops all cached blocks.
+     */
+    void clear();
+
+    Statistics statistics() const;
+
+private:
+    typedef std::vector<char> Block;
+    typedef std::shared_ptr<const Block> BlockPointer;
+
+    struct BlockKey {
+        FileKey file;
+        std::uint64_t block;
+
+        bool operator==(const BlockKey &o) const {
+            return (file == o.file) && (block == o.block);
+        }
+    };
+
+    struct BlockKeyHash {
+        std::size_t operator()(const BlockKey &key) const;
+    };
+
+    struct Entry {
+        BlockKey key;
+        BlockPointer data;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    /** Returns cached block (and bumps it) or null. Must be called under
+     *  lock.
+     */
+    BlockPointer find(const BlockKey &key);
+
+    /** Inserts loaded block and trims cache. Must be called under lock.
+     */
+    void insert(const BlockKey &key, const BlockPointer &data);
+
+    /** Evicts LRU blocks until under budget. Must be called under lock.
+     */
+    void trim();
+
+    const std::size_t blockSize_;
+
+    mutable std::mutex mutex_;
+
+    std::size_t budget_;
+
+    /** Entries in LRU order, most recently used at the end.
+     */
+    EntryList entries_;
+    std::unordered_map<BlockKey, EntryList::iterator, BlockKeyHash> index_;
+
+    Statistics stats_;
+};
+
+} } // namespace utility::io
+
+#endif // utility_block_cache_hpp_included_
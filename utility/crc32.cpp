@@ -0,0 +1,277 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <array>
+#include <stdexcept>
+
+#include "dbglog/dbglog.hpp"
+
+#include "crc32.hpp"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#  define UTILITY_CRC32_PCLMUL 1
+#  include <cpuid.h>
+#  include <immintrin.h>
+#endif
+
+namespace utility {
+
+namespace detail {
+
+namespace {
+
+/** Reversed CRC-32 polynomial.
+ */
+const std::uint32_t Polynomial(0xedb88320u);
+
+typedef std::array<std::array<std::uint32_t, 256>, 8> SlicingTables;
+
+SlicingTables makeTables()
+{
+    SlicingTables t;
+    for (std::uint32_t i(0); i < 256; ++i) {
+        auto crc(i);
+        for (int bit(0); bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? Polynomial : 0);
+        }
+        t[0][i] = crc;
+    }
+
+    for (std::uint32_t i(0); i < 256; ++i) {
+        for (std::size_t k(1); k < t.size(); ++k) {
+            t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xff];
+        }
+    }
+    return t;
+}
+
+const SlicingTables& tables()
+{
+    static const SlicingTables t(makeTables());
+    return t;
+}
+
+inline std::uint32_t load32(const unsigned char *p)
+{
+    return (std::uint32_t(p[0]) | (std::uint32_t(p[1]) << 8)
+            | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24));
+}
+
+} // namespace
+
+std::uint32_t crc32Slicing8(const void *data, std::size_t size
+                            , std::uint32_t crc)
+{
+    const auto &t(tables());
+    auto p(static_cast<const unsigned char*>(data));
+
+    crc = ~crc;
+    for (; size >= 8; p += 8, size -= 8) {
+        const auto one(load32(p) ^ crc);
+        const auto two(load32(p + 4));
+        crc = (t[7][one & 0xff] ^ t[6][(one >> 8) & 0xff]
+               ^ t[5][(one >> 16) & 0xff] ^ t[4][one >> 24]
+               ^ t[3][two & 0xff] ^ t[2][(two >> 8) & 0xff]
+               ^ t[1][(two >> 16) & 0xff] ^ t[0][two >> 24]);
+    }
+
+    for (; size; ++p, --size) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p) & 0xff];
+    }
+
+    return ~crc;
+}
+
+#ifdef UTILITY_CRC32_PCLMUL
+
+namespace {
+
+#define UTILITY_CRC32_TARGET __attribute__((target("pclmul,sse4.1")))
+
+UTILITY_CRC32_TARGET
+inline __m128i load(const unsigned char *p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+/** Folds 128 bits of x over next 128 bits using multiplier k.
+ */
+UTILITY_CRC32_TARGET
+inline __m128i fold(__m128i x, __m128i k, __m128i next)
+{
+    const auto lo(_mm_clmulepi64_si128(x, k, 0x00));
+    x = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(x, next), lo);
+}
+
+/** Folds 64 byte blocks of data using carry-less multiplication, see Intel's
+ *  "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ
+ *  Instruction". Size must be a multiple of 16 and at least 64. Operates on
+ *  inverted CRC.
+ */
+UTILITY_CRC32_TARGET
+std::uint32_t foldPclmul(const unsigned char *p, std::size_t size
+                         , std::uint32_t crc)
+{
+    // bit-reflected folding and Barrett reduction constants
+    alignas(16) static const std::uint64_t k1k2[]
+        = { 0x0154442bd4, 0x01c6e41596 };
+    alignas(16) static const std::uint64_t k3k4[]
+        = { 0x01751997d0, 0x00ccaa009e };
+    alignas(16) static const std::uint64_t k5k0[]
+        = { 0x0163cd6124, 0x0000000000 };
+    alignas(16) static const std::uint64_t poly[]
+        = { 0x01db710641, 0x01f7011641 };
+
+    auto x1(load(p));
+    auto x2(load(p + 0x10));
+    auto x3(load(p + 0x20));
+    auto x4(load(p + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+
+    auto x0(_mm_load_si128(reinterpret_cast<const __m128i*>(k1k2)));
+    p += 64;
+    size -= 64;
+
+    // fold 4 x 128 bits in parallel
+    for (; size >= 64; p += 64, size -= 64) {
+        x1 = fold(x1, x0, load(p));
+        x2 = fold(x2, x0, load(p + 0x10));
+        x3 = fold(x3, x0, load(p + 0x20));
+        x4 = fold(x4, x0, load(p + 0x30));
+    }
+
+    // fold 512 bits into 128 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(k3k4));
+    x1 = fold(x1, x0, x2);
+    x1 = fold(x1, x0, x3);
+    x1 = fold(x1, x0, x4);
+
+    // fold remaining 128 bit blocks
+    for (; size >= 16; p += 16, size -= 16) {
+        x1 = fold(x1, x0, load(p));
+    }
+
+    // fold 128 bits into 64 bits
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    // Barrett reduction to 32 bits
+    x0 = _mm_load_si128(reinterpret_cast<const __m128i*>(poly));
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return _mm_extract_epi32(x1, 1);
+}
+
+} // namespace
+
+std::uint32_t crc32Pclmul(const void *data, std::size_t size
+                          , std::uint32_t crc)
+{
+    auto p(static_cast<const unsigned char*>(data));
+
+    if (size >= 64) {
+        const auto chunk(size & ~std::size_t(15));
+        crc = ~foldPclmul(p, chunk, ~crc);
+        p += chunk;
+        size -= chunk;
+    }
+
+    // short data and tail
+    return crc32Slicing8(p, size, crc);
+}
+
+bool crc32PclmulSupported()
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) { return false; }
+    return (ecx & bit_PCLMUL) && (ecx & bit_SSE4_1);
+}
+
+#else // UTILITY_CRC32_PCLMUL
+
+std::uint32_t crc32Pclmul(const void*, std::size_t, std::uint32_t)
+{
+    LOGTHROW(err2, std::runtime_error)
+        << "PCLMULQDQ CRC-32 is not available on this platform.";
+    throw;
+}
+
+bool crc32PclmulSupported() { return false; }
+
+#endif // UTILITY_CRC32_PCLMUL
+
+} // namespace detail
+
+namespace {
+
+typedef std::uint32_t (*Crc32Function)(const void*, std::size_t
+                                       , std::uint32_t);
+
+struct Implementation {
+    Crc32Function function;
+    const char *name;
+};
+
+Implementation selectImplementation()
+{
+    if (detail::crc32PclmulSupported()) {
+        return { &detail::crc32Pclmul, "pclmul" };
+    }
+    return { &detail::crc32Slicing8, "slicing-by-8" };
+}
+
+const Implementation& implementation()
+{
+    static const Implementation impl(selectImplementation());
+    return impl;
+}
+
+} // namespace
+
+std::uint32_t crc32(const void *data, std::size_t size, std::uint32_t crc)
+{
+    return implementation().function(data, size, crc);
+}
+
+const char* crc32Implementation()
+{
+    return implementation().name;
+}
+
+} // namespace utility
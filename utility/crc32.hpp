@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_crc32_hpp_included_
+#define utility_crc32_hpp_included_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace utility {
+
+/** Computes CRC-32 (the ISO-HDLC variant used by ZIP, gzip or PNG) of given
+ *  data. Continues computation from given CRC, i.e. large data can be
+ *  processed in parts. Start with zero.
+ *
+ *  Uses PCLMULQDQ based kernel when supported by the CPU, slicing-by-8
+ *  table implementation otherwise. Selected once at runtime.
+ */
+std::uint32_t crc32(const void *data, std::size_t size
+                    , std::uint32_t crc = 0);
+
+/** Name of CRC-32 implementation selected for this CPU.
+ */
+const char* crc32Implementation();
+
+/** Incremental CRC-32 computation. Drop-in replacement for the used subset
+ *  of boost::crc_32_type.
+ */
+class Crc32 {
+public:
+    Crc32() : crc_() {}
+
+    void process_bytes(const void *data, std::size_t size) {
+        crc_ = crc32(data, size, crc_);
+    }
+
+    std::uint32_t checksum() const { return crc_; }
+
+    void reset() { crc_ = 0; }
+
+private:
+    std::uint32_t crc_;
+};
+
+namespace detail {
+
+/** Portable slicing-by-8 implementation.
+ */
+std::uint32_t crc32Slicing8(const void *data, std::size_t size
+                            , std::uint32_t crc);
+
+/** PCLMULQDQ folding implementation. Available only if
+ *  crc32PclmulSupported() returns true.
+ */
+std::uint32_t crc32Pclmul(const void *data, std::size_t size
+                          , std::uint32_t crc);
+
+/** Returns true if this build and this CPU support crc32Pclmul().
+ */
+bool crc32PclmulSupported();
+
+} // namespace detail
+
+} // namespace utility
+
+#endif // utility_crc32_hpp_included_
@@ -116,6 +116,58 @@ FileStat FileStat::from(int fd, std::nothrow_t)
     return FileStat(s.st_mtime, s.st_size, FileId(s.st_dev, s.st_ino));
 }
 
+namespace {
+
+std::int64_t nsec(const struct ::timespec &ts)
+{
+    return std::int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+FileKey fileKey(const struct ::stat &s)
+{
+#ifdef __APPLE__
+    return { std::uint64_t(s.st_dev), std::uint64_t(s.st_ino)
+            , std::uint64_t(s.st_size)
+            , nsec(s.st_mtimespec), nsec(s.st_ctimespec) };
+#else
+    return { std::uint64_t(s.st_dev), std::uint64_t(s.st_ino)
+            , std::uint64_t(s.st_size)
+            , nsec(s.st_mtim), nsec(s.st_ctim) };
+#endif
+}
+
+} // namespace
+
+FileKey FileKey::from(const boost::filesystem::path &path)
+{
+    struct ::stat s;
+
+    if (-1 == ::stat(path.c_str(), &s)) {
+        std::system_error e
+            (errno, std::system_category()
+             , formatError("Cannot stat file %s.", path));
+        LOG(err1) << e.what();
+        throw e;
+    }
+
+    return fileKey(s);
+}
+
+FileKey FileKey::from(int fd)
+{
+    struct ::stat s;
+
+    if (-1 == ::fstat(fd, &s)) {
+        std::system_error e
+            (errno, std::system_category()
+             , formatError("Cannot stat fd %d.", fd));
+        LOG(err1) << e.what();
+        throw e;
+    }
+
+    return fileKey(s);
+}
+
 std::time_t lastModified(const boost::filesystem::path &path)
 {
     struct ::stat buf;
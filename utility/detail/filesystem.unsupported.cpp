@@ -52,4 +52,18 @@ FileStat FileStat::from(const boost::filesystem::path &path
     throw;
 }
 
+FileKey FileKey::from(const boost::filesystem::path &path)
+{
+    LOGTHROW(err4, std::runtime_error)
+        << "FileKey(" << path << ") unsupported on this platform.";
+    throw;
+}
+
+FileKey FileKey::from(int fd)
+{
+    LOGTHROW(err4, std::runtime_error)
+        << "FileKey(" << fd << ") unsupported on this platform.";
+    throw;
+}
+
 } // namespace utility
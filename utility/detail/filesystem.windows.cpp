@@ -24,6 +24,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <Windows.h>
 #include <io.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -116,6 +117,72 @@ FileStat FileStat::from(int fd, std::nothrow_t)
     return FileStat(s.st_mtime, s.st_size, FileId(s.st_dev, s.st_ino));
 }
 
+namespace {
+
+/** Raw 100ns ticks; converting to nanoseconds would overflow and the key
+ *  only needs to be compared for equality anyway.
+ */
+std::int64_t ticks(const FILETIME &ft)
+{
+    return (std::int64_t(ft.dwHighDateTime) << 32) + ft.dwLowDateTime;
+}
+
+FileKey fileKey(const ::BY_HANDLE_FILE_INFORMATION &info)
+{
+    // st_ino is always zero on Windows, use file index instead
+    const auto modified(ticks(info.ftLastWriteTime));
+    return { std::uint64_t(info.dwVolumeSerialNumber)
+            , ((std::uint64_t(info.nFileIndexHigh) << 32)
+               + info.nFileIndexLow)
+            , ((std::uint64_t(info.nFileSizeHigh) << 32)
+               + info.nFileSizeLow)
+            , modified, modified };
+}
+
+} // namespace
+
+FileKey FileKey::from(const boost::filesystem::path &path)
+{
+    const auto handle(::CreateFileW
+                      (path.wstring().c_str(), FILE_READ_ATTRIBUTES
+                       , (FILE_SHARE_READ | FILE_SHARE_WRITE
+                          | FILE_SHARE_DELETE)
+                       , nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS
+                       , nullptr));
+    ::BY_HANDLE_FILE_INFORMATION info;
+    const bool ok((handle != INVALID_HANDLE_VALUE)
+                  && ::GetFileInformationByHandle(handle, &info));
+    const auto error(::GetLastError());
+    if (handle != INVALID_HANDLE_VALUE) { ::CloseHandle(handle); }
+
+    if (!ok) {
+        std::system_error e
+            (int(error), std::system_category()
+             , formatError("Cannot stat file %s.", path));
+        LOG(err1) << e.what();
+        throw e;
+    }
+
+    return fileKey(info);
+}
+
+FileKey FileKey::from(int fd)
+{
+    const auto handle(reinterpret_cast<HANDLE>(::_get_osfhandle(fd)));
+    ::BY_HANDLE_FILE_INFORMATION info;
+    if ((handle == INVALID_HANDLE_VALUE)
+        || !::GetFileInformationByHandle(handle, &info))
+    {
+        std::system_error e
+            (int(::GetLastError()), std::system_category()
+             , formatError("Cannot stat fd %d.", fd));
+        LOG(err1) << e.what();
+        throw e;
+    }
+
+    return fileKey(info);
+}
+
 std::time_t lastModified(const boost::filesystem::path &path)
 {
     struct ::_stat buf;
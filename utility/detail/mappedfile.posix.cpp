@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+#include "dbglog/dbglog.hpp"
+
+#include "../mappedfile.hpp"
+
+namespace utility {
+
+namespace {
+
+int advice2posix(MappedFile::Advice advice)
+{
+    switch (advice) {
+    case MappedFile::Advice::normal: return POSIX_MADV_NORMAL;
+    case MappedFile::Advice::sequential: return POSIX_MADV_SEQUENTIAL;
+    case MappedFile::Advice::random: return POSIX_MADV_RANDOM;
+    case MappedFile::Advice::willNeed: return POSIX_MADV_WILLNEED;
+    case MappedFile::Advice::dontNeed: return POSIX_MADV_DONTNEED;
+    }
+    return POSIX_MADV_NORMAL;
+}
+
+std::size_t fileSize(const Filedes &fd)
+{
+    struct ::stat st;
+    if (-1 == ::fstat(fd, &st)) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot stat file " << fd.path() << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+    return st.st_size;
+}
+
+} // namespace
+
+MappedFile::MappedFile(const Filedes &fd)
+    : path_(fd.path()), data_(), size_()
+{
+    map(fd, fileSize(fd));
+}
+
+MappedFile::MappedFile(const Filedes &fd, std::size_t size)
+    : path_(fd.path()), data_(), size_()
+{
+    map(fd, size);
+}
+
+MappedFile::~MappedFile()
+{
+    if (!data_) { return; }
+
+    if (-1 == ::munmap(const_cast<char*>(data_), size_)) {
+        std::system_error e(errno, std::system_category());
+        LOG(warn2) << "Cannot unmap file " << path_ << ": <"
+                   << e.code() << ", " << e.what() << ">.";
+    }
+}
+
+void MappedFile::map(int fd, std::size_t size)
+{
+    // nothing to map
+    if (!size) { return; }
+
+    auto data(::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0));
+    if (data == MAP_FAILED) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot map file " << path_ << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+
+    data_ = static_cast<const char*>(data);
+    size_ = size;
+}
+
+void MappedFile::advise(Advice advice, std::size_t offset
+                        , std::size_t size) const
+{
+    if (offset >= size_) { return; }
+    if (size > (size_ - offset)) { size = size_ - offset; }
+
+    // align start to page boundary
+    static const std::size_t pageSize(::sysconf(_SC_PAGESIZE));
+    const auto aligned(offset - (offset % pageSize));
+    size += (offset - aligned);
+
+    const auto res(::posix_madvise(const_cast<char*>(data_) + aligned, size
+                                   , advice2posix(advice)));
+    if (res) {
+        std::system_error e(res, std::system_category());
+        LOG(warn1) << "Cannot advise on mapping of file " << path_ << ": <"
+                   << e.code() << ", " << e.what() << ">.";
+    }
+}
+
+} // namespace utility
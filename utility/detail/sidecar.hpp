@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+/** Common header of sidecar files (e.g. seek indices) stored next to the
+ *  file they describe.
+ */
+
+#ifndef utility_detail_sidecar_hpp_included_
+#define utility_detail_sidecar_hpp_included_
+
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <istream>
+#include <ostream>
+
+#include <boost/filesystem/path.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "../binaryio.hpp"
+#include "../filesystem.hpp"
+
+namespace utility { namespace detail {
+
+/** Writes sidecar header: magic followed by precise identity of the
+ *  described file (see utility::FileKey).
+ */
+template <std::size_t N>
+void writeSidecarHeader(std::ostream &os, const char (&magic)[N]
+                        , const FileKey &key)
+{
+    binaryio::write(os, magic);
+    binaryio::write(os, std::uint64_t(key.dev));
+    binaryio::write(os, std::uint64_t(key.ino));
+    binaryio::write(os, std::uint64_t(key.size));
+    binaryio::write(os, std::int64_t(key.modified));
+    binaryio::write(os, std::int64_t(key.changed));
+}
+
+/** Reads and checks sidecar header. Returns false (logging the reason) when
+ *  magic doesn't match or the described file has changed since the sidecar
+ *  was written.
+ *
+ * \param what sidecar kind for log messages, e.g. "zip seek index"
+ */
+template <std::size_t N>
+bool readSidecarHeader(std::istream &is, const char (&magic)[N]
+                       , const FileKey &key
+                       , const boost::filesystem::path &path
+                       , const char *what)
+{
+    char data[N];
+    binaryio::read(is, data);
+    if (!is || !std::equal(data, data + N, magic)) {
+        LOG(warn2) << "File " << path << " is not a " << what << ".";
+        return false;
+    }
+
+    FileKey stored;
+    stored.dev = binaryio::read<std::uint64_t>(is);
+    stored.ino = binaryio::read<std::uint64_t>(is);
+    stored.size = binaryio::read<std::uint64_t>(is);
+    stored.modified = binaryio::read<std::int64_t>(is);
+    stored.changed = binaryio::read<std::int64_t>(is);
+    if (!is || (stored != key)) {
+        LOG(info2) << "The " << what << " " << path << " is stale.";
+        return false;
+    }
+
+    return true;
+}
+
+} } // namespace utility::detail
+
+#endif // utility_detail_sidecar_hpp_included_
@@ -0,0 +1,131 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+
+#include <cerrno>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#include "dbglog/dbglog.hpp"
+
+#include "../zerocopy.hpp"
+
+namespace utility {
+
+namespace {
+
+/** Maximum number of bytes transferred by single syscall.
+ */
+const std::size_t MaxChunk(1 << 30);
+
+/** Copy result: number of copied bytes, 0 at end of input, -1 when given
+ *  method is not usable for these files.
+ */
+typedef ::ssize_t Result;
+
+/** Errors meaning "try something else".
+ */
+bool unsupported(int error)
+{
+    switch (error) {
+    case ENOSYS: case EXDEV: case EINVAL: case EOPNOTSUPP: case EBADF:
+    case ETXTBSY: case EPERM:
+        return true;
+    }
+    return false;
+}
+
+Result copyFileRange(int in, ::loff_t &offset, std::size_t size, int out)
+{
+#ifdef SYS_copy_file_range
+    for (;;) {
+        // raw syscall: glibc may emulate copy_file_range in user space
+        const auto res(::syscall(SYS_copy_file_range, in, &offset
+                                 , out, nullptr, size, 0u));
+        if (res >= 0) { return res; }
+        if (errno == EINTR) { continue; }
+        if (unsupported(errno)) { return -1; }
+
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "copy_file_range failed: <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+#else
+    (void) in; (void) offset; (void) size; (void) out;
+    return -1;
+#endif
+}
+
+Result sendFile(int in, ::loff_t &offset, std::size_t size, int out)
+{
+    for (;;) {
+        ::off_t off(offset);
+        const auto res(::sendfile(out, in, &off, size));
+        if (res >= 0) {
+            offset = off;
+            return res;
+        }
+        if (errno == EINTR) { continue; }
+        if (unsupported(errno)) { return -1; }
+
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "sendfile failed: <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+}
+
+} // namespace
+
+void copyRange(const Filedes &in, std::uint64_t offset, std::size_t size
+               , const Filedes &out)
+{
+    ::loff_t off(offset);
+
+    // try methods from the best one, stick with the first one that works
+    for (const auto method : { &copyFileRange, &sendFile }) {
+        while (size) {
+            const auto res(method(in, off, std::min(size, MaxChunk), out));
+            if (res < 0) { break; }
+            if (!res) {
+                LOGTHROW(err2, std::runtime_error)
+                    << "File " << in.path() << " is shorter than expected.";
+            }
+            size -= res;
+        }
+        if (!size) { return; }
+    }
+
+    // fallback
+    detail::copyRangeReadWrite(in, off, size, out);
+}
+
+} // namespace utility
@@ -27,6 +27,7 @@
 #include <sys/stat.h>
 
 #include <cerrno>
+#include <fstream>
 #include <system_error>
 
 #include <boost/filesystem/operations.hpp>
@@ -185,6 +186,29 @@ std::map<std::string, fs::path> id2path(const std::vector<fs::path> &localPaths)
     return result;
 }
 
+void writeFileAtomically(const fs::path &path
+                         , const std::function<void(std::ostream&)> &writer)
+{
+    const fs::path tmpPath
+        (path.string() + fs::unique_path(".%%%%-%%%%-%%%%.tmp").string());
+
+    try {
+        std::ofstream f;
+        f.exceptions(std::ios::badbit | std::ios::failbit);
+        f.open(tmpPath.string()
+               , std::ios_base::out | std::ios_base::trunc
+               | std::ios_base::binary);
+        writer(f);
+        f.close();
+
+        fs::rename(tmpPath, path);
+    } catch (...) {
+        bs::error_code ec;
+        fs::remove(tmpPath, ec);
+        throw;
+    }
+}
+
 namespace {
 
 std::size_t removeDirContentsOneFs(const fs::path &dir, std::uint64_t device
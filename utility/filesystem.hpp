@@ -30,6 +30,8 @@
 #include <new>
 #include <ctime>
 #include <map>
+#include <iosfwd>
+#include <functional>
 
 #include <boost/filesystem/path.hpp>
 
@@ -115,6 +117,43 @@ struct FileStat {
     static FileStat from(int fd, std::nothrow_t);
 };
 
+/** Writes file atomically. Content is written by given writer into uniquely
+ *  named temporary file next to path which then replaces path; concurrent
+ *  writers therefore never clash. Temporary file is removed on any failure.
+ *  Stream passed to writer throws on I/O errors.
+ */
+void writeFileAtomically(const boost::filesystem::path &path
+                         , const std::function<void(std::ostream&)> &writer);
+
+/** Precise file identity: device, inode, size and modification and status
+ *  change time in nanoseconds (Windows: volume serial number, file index,
+ *  size and last write time in 100ns ticks). Unlike FileStat it changes even
+ *  when file is rewritten in place within the same second.
+ */
+struct FileKey {
+    std::uint64_t dev;
+    std::uint64_t ino;
+    std::uint64_t size;
+    std::int64_t modified;
+    std::int64_t changed;
+
+    bool operator==(const FileKey &o) const {
+        return ((dev == o.dev) && (ino == o.ino) && (size == o.size)
+                && (modified == o.modified) && (changed == o.changed));
+    }
+
+    bool operator!=(const FileKey &o) const { return !operator==(o); }
+
+    /** Returns identity of file at given path. Throws std::system_error on
+     *  failure.
+     */
+    static FileKey from(const boost::filesystem::path &path);
+
+    /** Returns identity of open file. Throws std::system_error on failure.
+     */
+    static FileKey from(int fd);
+};
+
 struct RemoveAllFlags {
     /** Skip any directory that is on a file system different from that of the
      *  remove_all argument (or .device, if nonzero).
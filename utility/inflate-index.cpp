@@ -0,0 +1,624 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#include <zlib.h>
+
+#include "dbglog/dbglog.hpp"
+
+#include "unistd_compat.hpp"
+#include "binaryio.hpp"
+#include "inflate-index.hpp"
+
+namespace bin = utility::binaryio;
+
+namespace utility {
+
+constexpr std::size_t InflateIndex::WindowSize;
+constexpr std::size_t InflateIndex::DefaultSpan;
+
+namespace {
+
+/** Size of compressed data input buffer.
+ */
+const std::size_t InputSize(1 << 16);
+
+/** Window bits for raw deflate stream.
+ */
+const int RawWindowBits(-15);
+
+/** Window bits for gzip stream.
+ */
+const int GzipWindowBits(15 + 16);
+
+/** Size of gzip member trailer (CRC32 + ISIZE).
+ */
+const std::size_t GzipTrailerSize(8);
+
+const char IndexMagic[8] = { 'I', 'N', 'F', 'L', 'I', 'D', 'X', '1' };
+
+int windowBits(InflateIndex::Format format)
+{
+    return ((format == InflateIndex::Format::gzip)
+            ? GzipWindowBits : RawWindowBits);
+}
+
+/** Inflate stream fed from a positional source.
+ */
+class Inflater {
+public:
+    Inflater(const InflateIndex::Source &source)
+        : source_(source), pos_(), initialized_(false)
+    {
+        std::memset(&strm, 0, sizeof(strm));
+    }
+
+    ~Inflater() {
+        if (initialized_) { ::inflateEnd(&strm); }
+    }
+
+    Inflater(const Inflater&) = delete;
+    Inflater& operator=(const Inflater&) = delete;
+
+    /** (Re)starts decompression with given window bits.
+     */
+    void reset(int windowBits) {
+        if (!initialized_) {
+            check(::inflateInit2(&strm, windowBits), "inflateInit2");
+            initialized_ = true;
+        } else {
+            check(::inflateReset2(&strm, windowBits), "inflateReset2");
+        }
+    }
+
+    /** Drops buffered input and continues reading at given offset.
+     */
+    void seekInput(std::uint64_t offset) {
+        pos_ = offset;
+        strm.next_in = nullptr;
+        strm.avail_in = 0;
+    }
+
+    /** Makes sure there is some input available. Returns false at the end of
+     *  compressed data.
+     */
+    bool fill() {
+        if (strm.avail_in) { return true; }
+        const auto bytes(source_(reinterpret_cast<char*>(in_), sizeof(in_)
+                                 , pos_));
+        pos_ += bytes;
+        strm.next_in = in_;
+        strm.avail_in = bytes;
+        return bytes;
+    }
+
+    /** Offset of next unprocessed byte of compressed data.
+     */
+    std::uint64_t inPos() const { return pos_ - strm.avail_in; }
+
+    /** Checks result of inflate call.
+     */
+    void check(int res, const char *what) const {
+        switch (res) {
+        case Z_OK: case Z_STREAM_END: case Z_BUF_ERROR: return;
+        case Z_MEM_ERROR: throw std::bad_alloc();
+        default: break;
+        }
+
+        LOGTHROW(err2, std::runtime_error)
+            << "Inflate failed in " << what << ": "
+            << (strm.msg ? strm.msg : "unknown error")
+            << " (code " << res << ").";
+    }
+
+    z_stream strm;
+
+private:
+    InflateIndex::Source source_;
+    std::uint64_t pos_;
+    bool initialized_;
+    unsigned char in_[InputSize];
+};
+
+void truncated()
+{
+    LOGTHROW(err2, std::runtime_error)
+        << "Unexpected end of compressed data.";
+}
+
+} // namespace
+
+const InflateIndex::Checkpoint&
+InflateIndex::checkpoint(std::uint64_t offset) const
+{
+    auto icheckpoints
+        (std::upper_bound(checkpoints_.begin(), checkpoints_.end(), offset
+                          , [](std::uint64_t offset, const Checkpoint &cp)
+    {
+        return offset < cp.out;
+    }));
+
+    // first checkpoint is always at zero
+    return *std::prev(icheckpoints);
+}
+
+struct InflateIndex::Builder::Detail {
+    Detail(const Source &source, Format format, std::size_t span)
+        : inflater(source)
+        , index(new InflateIndex(format, std::max(span, WindowSize)))
+        , window(WindowSize), wpos(), filled(), total(), last(), done()
+    {
+        inflater.reset(windowBits(format));
+
+        // start of data
+        index->checkpoints_.emplace_back();
+    }
+
+    std::streamsize read(char *data, std::streamsize size);
+
+    /** Keeps last WindowSize bytes of output in the window ring.
+     */
+    void remember(const unsigned char *data, std::size_t size);
+
+    void checkpoint();
+
+    Inflater inflater;
+    std::shared_ptr<InflateIndex> index;
+
+    /** Ring buffer with last WindowSize bytes of output.
+     */
+    std::vector<unsigned char> window;
+    std::size_t wpos;
+    std::size_t filled;
+
+    std::uint64_t total;
+    std::uint64_t last;
+    bool done;
+};
+
+void InflateIndex::Builder::Detail::remember(const unsigned char *data
+                                             , std::size_t size)
+{
+    if (size >= WindowSize) {
+        std::copy(data + size - WindowSize, data + size, window.begin());
+        wpos = 0;
+        filled = WindowSize;
+        return;
+    }
+
+    const auto head(std::min(size, WindowSize - wpos));
+    std::copy(data, data + head, window.begin() + wpos);
+    std::copy(data + head, data + size, window.begin());
+    wpos = (wpos + size) % WindowSize;
+    filled = std::min(filled + size, WindowSize);
+}
+
+void InflateIndex::Builder::Detail::checkpoint()
+{
+    auto &strm(inflater.strm);
+    index->checkpoints_.emplace_back(total, inflater.inPos()
+                                     , strm.data_type & 7);
+    auto &w(index->checkpoints_.back().window);
+
+    // linearize window ring
+    w.reserve(filled);
+    if (filled == WindowSize) {
+        w.insert(w.end(), window.begin() + wpos, window.end());
+    }
+    w.insert(w.end(), window.begin(), window.begin() + wpos);
+
+    last = total;
+}
+
+std::streamsize InflateIndex::Builder::Detail::read(char *data
+                                                    , std::streamsize size)
+{
+    if (done) { return -1; }
+
+    auto &strm(inflater.strm);
+    strm.next_out = reinterpret_cast<unsigned char*>(data);
+    strm.avail_out = size;
+
+    while (strm.avail_out) {
+        // NB: inflate can have pending output even without any input
+        const bool input(inflater.fill());
+
+        auto *out(strm.next_out);
+        const auto res(::inflate(&strm, Z_BLOCK));
+        inflater.check(res, "inflate");
+        if ((res == Z_BUF_ERROR) && !input) { truncated(); }
+
+        const std::size_t produced(strm.next_out - out);
+        remember(out, produced);
+        total += produced;
+
+        if (res == Z_STREAM_END) {
+            // next gzip member, if any
+            if ((index->format_ == Format::gzip) && inflater.fill()) {
+                inflater.reset(GzipWindowBits);
+                continue;
+            }
+
+            done = true;
+            index->size_ = total;
+            index->compressedSize_ = inflater.inPos();
+            break;
+        }
+
+        // record checkpoint at block boundary (except after last block)
+        if ((strm.data_type & 128) && !(strm.data_type & 64)
+            && ((total - last) > index->span_))
+        {
+            checkpoint();
+        }
+    }
+
+    const std::streamsize bytes(size - strm.avail_out);
+    return (bytes || !done) ? bytes : -1;
+}
+
+InflateIndex::Builder::Builder(const Source &source, Format format
+                               , std::size_t span)
+    : detail_(std::make_shared<Detail>(source, format, span))
+{}
+
+std::streamsize InflateIndex::Builder::read(char *data, std::streamsize size)
+{
+    return detail_->read(data, size);
+}
+
+std::uint64_t InflateIndex::Builder::position() const
+{
+    return detail_->total;
+}
+
+InflateIndex::pointer InflateIndex::Builder::index() const
+{
+    if (!detail_->done) {
+        LOGTHROW(err2, std::logic_error)
+            << "Inflate index is not complete until all data are read.";
+    }
+    return detail_->index;
+}
+
+InflateIndex::pointer InflateIndex::build(const Source &source, Format format
+                                          , std::size_t span)
+{
+    Builder builder(source, format, span);
+    std::vector<char> buffer(InputSize * 4);
+    while (builder.read(buffer.data(), buffer.size()) >= 0);
+    return builder.index();
+}
+
+struct InflateIndex::Device::Detail {
+    Detail(const pointer &index, const Source &source)
+        : index(index), inflater(source), pos(), out(), valid(), ended()
+        , raw(), skip()
+    {}
+
+    std::streamsize read(char *data, std::streamsize size);
+
+    /** Restarts decompression at given checkpoint.
+     */
+    void restart(const Checkpoint &cp);
+
+    /** Continues with next gzip member, if any.
+     */
+    void nextMember();
+
+    /** Inflates up to size bytes of data.
+     */
+    std::size_t inflate(unsigned char *data, std::size_t size);
+
+    pointer index;
+    Inflater inflater;
+
+    /** Requested position.
+     */
+    std::uint64_t pos;
+
+    /** Position of decompressor.
+     */
+    std::uint64_t out;
+
+    bool valid;
+    bool ended;
+
+    /** Decompressing raw deflate data (i.e. no gzip framing).
+     */
+    bool raw;
+
+    /** Number of gzip trailer bytes to skip before next member.
+     */
+    std::size_t skip;
+};
+
+void InflateIndex::Device::Detail::restart(const Checkpoint &cp)
+{
+    auto &strm(inflater.strm);
+
+    if (&cp == &index->checkpoints().front()) {
+        // start of data, use format's own framing
+        inflater.reset(windowBits(index->format()));
+        inflater.seekInput(0);
+        raw = (index->format() == Format::raw);
+    } else {
+        inflater.reset(RawWindowBits);
+        inflater.seekInput(cp.in - (cp.bits ? 1 : 0));
+
+        if (cp.bits) {
+            if (!inflater.fill()) { truncated(); }
+            const int byte(*strm.next_in);
+            ++strm.next_in;
+            --strm.avail_in;
+            inflater.check(::inflatePrime(&strm, cp.bits
+                                          , byte >> (8 - cp.bits))
+                           , "inflatePrime");
+        }
+
+        if (!cp.window.empty()) {
+            inflater.check(::inflateSetDictionary
+                           (&strm, cp.window.data(), cp.window.size())
+                           , "inflateSetDictionary");
+        }
+
+        raw = true;
+    }
+
+    out = cp.out;
+    valid = true;
+    ended = false;
+    skip = 0;
+}
+
+void InflateIndex::Device::Detail::nextMember()
+{
+    if (!inflater.fill()) {
+        ended = true;
+        return;
+    }
+
+    inflater.reset(GzipWindowBits);
+    raw = false;
+}
+
+std::size_t InflateIndex::Device::Detail::inflate(unsigned char *data
+                                                  , std::size_t size)
+{
+    auto &strm(inflater.strm);
+    strm.next_out = data;
+    strm.avail_out = size;
+
+    while (strm.avail_out && !ended) {
+        // NB: inflate can have pending output even without any input
+        const bool input(inflater.fill());
+
+        if (skip) {
+            // skip trailer of member decoded in raw mode
+            if (!input) { truncated(); }
+            const auto bytes(std::min(std::size_t(strm.avail_in), skip));
+            strm.next_in += bytes;
+            strm.avail_in -= bytes;
+            if (!(skip -= bytes)) { nextMember(); }
+            continue;
+        }
+
+        const auto res(::inflate(&strm, Z_NO_FLUSH));
+        inflater.check(res, "inflate");
+        if ((res == Z_BUF_ERROR) && !input) { truncated(); }
+
+        if (res == Z_STREAM_END) {
+            if (index->format() != Format::gzip) {
+                ended = true;
+            } else if (raw) {
+                // raw inflate leaves member trailer in the input
+                skip = GzipTrailerSize;
+            } else {
+                nextMember();
+            }
+        }
+    }
+
+    const std::size_t produced(size - strm.avail_out);
+    out += produced;
+    return produced;
+}
+
+std::streamsize InflateIndex::Device::Detail::read(char *data
+                                                   , std::streamsize size)
+{
+    const auto total(index->size());
+    if (pos >= total) { return -1; }
+    if (std::uint64_t(size) > (total - pos)) { size = total - pos; }
+
+    // restart if we cannot get to requested position by inflating forward or
+    // if there is a checkpoint closer to it
+    const auto &cp(index->checkpoint(pos));
+    if (!valid || (pos < out) || (cp.out > out)) { restart(cp); }
+
+    // skip data up to requested position
+    if (out < pos) {
+        std::vector<unsigned char> discard
+            (std::min(pos - out, std::uint64_t(InputSize)));
+        while (out < pos) {
+            const auto bytes
+                (std::min(pos - out, std::uint64_t(discard.size())));
+            if (!inflate(discard.data(), bytes)) { truncated(); }
+        }
+    }
+
+    std::size_t produced(0);
+    while (produced < std::size_t(size)) {
+        const auto bytes
+            (inflate(reinterpret_cast<unsigned char*>(data) + produced
+                     , size - produced));
+        if (!bytes) { break; }
+        produced += bytes;
+    }
+
+    if (!produced) { truncated(); }
+
+    pos += produced;
+    return produced;
+}
+
+InflateIndex::Device::Device(const pointer &index, const Source &source)
+    : detail_(std::make_shared<Detail>(index, source))
+{}
+
+std::streamsize InflateIndex::Device::read(char *data, std::streamsize size)
+{
+    return detail_->read(data, size);
+}
+
+std::streampos InflateIndex::Device::seek(boost::iostreams::stream_offset off
+                                          , std::ios_base::seekdir way)
+{
+    auto &d(*detail_);
+    const std::int64_t size(d.index->size());
+
+    std::int64_t newPos(0);
+    switch (way) {
+    case std::ios_base::beg: newPos = off; break;
+    case std::ios_base::cur: newPos = d.pos + off; break;
+    case std::ios_base::end: newPos = size + off; break;
+    default: break;
+    }
+
+    d.pos = std::max(std::int64_t(0), std::min(newPos, size));
+    return d.pos;
+}
+
+void InflateIndex::save(std::ostream &os) const
+{
+    bin::write(os, IndexMagic);
+    bin::write(os, std::uint8_t(format_));
+    bin::write(os, std::uint64_t(span_));
+    bin::write(os, std::uint64_t(size_));
+    bin::write(os, std::uint64_t(compressedSize_));
+    bin::write(os, std::uint64_t(checkpoints_.size()));
+
+    for (const auto &cp : checkpoints_) {
+        bin::write(os, std::uint64_t(cp.out));
+        bin::write(os, std::uint64_t(cp.in));
+        bin::write(os, std::uint8_t(cp.bits));
+        bin::write(os, std::uint32_t(cp.window.size()));
+        bin::write(os, cp.window);
+    }
+}
+
+InflateIndex::pointer InflateIndex::load(std::istream &is)
+{
+    const auto malformed([&](const char *what)
+    {
+        LOGTHROW(err2, std::runtime_error)
+            << "Malformed inflate index: " << what << ".";
+    });
+
+    char magic[sizeof(IndexMagic)];
+    bin::read(is, magic);
+    if (!is || !std::equal(magic, magic + sizeof(magic), IndexMagic)) {
+        malformed("invalid magic");
+    }
+
+    const auto format(bin::read<std::uint8_t>(is));
+    if (format > std::uint8_t(Format::gzip)) { malformed("invalid format"); }
+
+    const auto span(bin::read<std::uint64_t>(is));
+    std::shared_ptr<InflateIndex> index
+        (new InflateIndex(static_cast<Format>(format), span));
+    index->size_ = bin::read<std::uint64_t>(is);
+    index->compressedSize_ = bin::read<std::uint64_t>(is);
+
+    const auto count(bin::read<std::uint64_t>(is));
+    if (!is || !count) { malformed("no checkpoints"); }
+
+    std::uint64_t prev(0);
+    for (std::uint64_t i(0); i < count; ++i) {
+        const auto out(bin::read<std::uint64_t>(is));
+        const auto in(bin::read<std::uint64_t>(is));
+        const auto bits(bin::read<std::uint8_t>(is));
+        const auto windowSize(bin::read<std::uint32_t>(is));
+
+        if (!is || (bits > 7) || (windowSize > WindowSize)
+            || (out < prev) || (out > index->size_)
+            || (in > index->compressedSize_) || (!i && (out || in)))
+        {
+            malformed("invalid checkpoint");
+        }
+        prev = out;
+
+        index->checkpoints_.emplace_back(out, in, bits);
+        auto &window(index->checkpoints_.back().window);
+        window.resize(windowSize);
+        bin::read(is, window);
+        if (!is) { malformed("truncated window"); }
+    }
+
+    return index;
+}
+
+InflateIndex::Source InflateIndex::source(int fd, std::uint64_t start
+                                          , std::uint64_t end)
+{
+    return [fd, start, end](char *data, std::size_t size
+                            , std::uint64_t offset) -> std::size_t
+    {
+        const auto pos(start + offset);
+        if (pos >= end) { return 0; }
+        size = std::min(std::uint64_t(size), end - pos);
+
+        for (;;) {
+            const auto bytes(::pread(fd, data, size, pos));
+            if (bytes >= 0) { return bytes; }
+            if (errno == EINTR) { continue; }
+
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Cannot read compressed data: <" << e.code()
+                      << ", " << e.what() << ">.";
+            throw e;
+        }
+    };
+}
+
+InflateIndex::Source InflateIndex::source(const char *data, std::size_t size
+                                          , std::shared_ptr<const void> owner)
+{
+    return [data, size, owner](char *out, std::size_t bytes
+                               , std::uint64_t offset) -> std::size_t
+    {
+        if (offset >= size) { return 0; }
+        bytes = std::min(std::uint64_t(bytes), size - offset);
+        std::memcpy(out, data + offset, bytes);
+        return bytes;
+    };
+}
+
+} // namespace utility
@@ -0,0 +1,227 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_inflate_index_hpp_included_
+#define utility_inflate_index_hpp_included_
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <functional>
+#include <iostream>
+
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/positioning.hpp>
+
+namespace utility {
+
+/** Random access into deflate compressed data.
+ *
+ *  Implements the approach of zlib's zran example: while the data are
+ *  inflated sequentially, a checkpoint is recorded at a deflate block boundary
+ *  every `span` bytes of uncompressed output. Each checkpoint holds position
+ *  in both compressed and uncompressed data and the inflate window (last 32
+ *  KiB of output) needed to resume decompression at that point. Any range can
+ *  then be read by inflating from the nearest preceding checkpoint, i.e. by
+ *  decompressing at most `span` bytes of unneeded data.
+ */
+class InflateIndex {
+public:
+    typedef std::shared_ptr<const InflateIndex> pointer;
+
+    /** Format of compressed data.
+     */
+    enum class Format {
+        /** Raw deflate stream (e.g. ZIP file entry).
+         */
+        raw
+
+        /** Gzip stream, possibly consisting of multiple members.
+         */
+        , gzip
+    };
+
+    /** Size of inflate window.
+     */
+    static constexpr std::size_t WindowSize = 1 << 15;
+
+    /** Default distance between checkpoints in uncompressed data.
+     */
+    static constexpr std::size_t DefaultSpan = 1 << 20;
+
+    /** Positional reader of compressed data. Reads up to size bytes from
+     *  given offset into compressed data. Returns number of bytes read, zero
+     *  at the end of data. Must be callable from any thread.
+     */
+    typedef std::function<std::size_t(char *data, std::size_t size
+                                      , std::uint64_t offset)> Source;
+
+    /** Point where decompression can be resumed.
+     */
+    struct Checkpoint {
+        /** Offset in uncompressed data.
+         */
+        std::uint64_t out;
+
+        /** Offset of first full byte in compressed data.
+         */
+        std::uint64_t in;
+
+        /** Number of bits (1-7) of byte at in - 1 that belong to the block
+         *  starting at this checkpoint, zero if the block is byte aligned.
+         */
+        int bits;
+
+        /** Uncompressed data preceding this checkpoint, up to WindowSize
+         *  bytes.
+         */
+        std::vector<unsigned char> window;
+
+        Checkpoint(std::uint64_t out = 0, std::uint64_t in = 0, int bits = 0)
+            : out(out), in(in), bits(bits)
+        {}
+    };
+
+    typedef std::vector<Checkpoint> Checkpoints;
+
+    Format format() const { return format_; }
+
+    /** Requested distance between checkpoints.
+     */
+    std::size_t span() const { return span_; }
+
+    /** Size of uncompressed data.
+     */
+    std::uint64_t size() const { return size_; }
+
+    /** Size of compressed data.
+     */
+    std::uint64_t compressedSize() const { return compressedSize_; }
+
+    /** All checkpoints, ordered by position. First checkpoint is always
+     *  start of the data.
+     */
+    const Checkpoints& checkpoints() const { return checkpoints_; }
+
+    /** Returns last checkpoint at or before given uncompressed offset.
+     */
+    const Checkpoint& checkpoint(std::uint64_t offset) const;
+
+    /** Builds index by inflating whole data. See Builder for building index
+     *  while consuming the data.
+     */
+    static pointer build(const Source &source, Format format
+                         , std::size_t span = DefaultSpan);
+
+    /** Saves index to output stream. Binary, native byte order.
+     */
+    void save(std::ostream &os) const;
+
+    /** Loads index saved by save(). Throws std::runtime_error on malformed
+     *  input.
+     */
+    static pointer load(std::istream &is);
+
+    /** Source reading from given range of a file descriptor.
+     */
+    static Source source(int fd, std::uint64_t start, std::uint64_t end);
+
+    /** Source reading from memory. Memory is kept alive by the owner.
+     */
+    static Source source(const char *data, std::size_t size
+                         , std::shared_ptr<const void> owner = {});
+
+    class Builder;
+    class Device;
+
+private:
+    InflateIndex(Format format, std::size_t span)
+        : format_(format), span_(span), size_(), compressedSize_()
+    {}
+
+    Format format_;
+    std::size_t span_;
+    std::uint64_t size_;
+    std::uint64_t compressedSize_;
+    Checkpoints checkpoints_;
+};
+
+/** Sequential input device providing uncompressed data while building the
+ *  index. Built index is available when the whole stream has been read.
+ *
+ *  Copies share state, i.e. a copy can be pushed into a filtering stream and
+ *  the index fetched from the original afterwards.
+ */
+class InflateIndex::Builder {
+public:
+    typedef char char_type;
+    typedef boost::iostreams::source_tag category;
+
+    Builder(const Source &source, Format format
+            , std::size_t span = DefaultSpan);
+
+    std::streamsize read(char *data, std::streamsize size);
+
+    /** Number of uncompressed bytes produced so far.
+     */
+    std::uint64_t position() const;
+
+    /** Returns built index. Throws std::logic_error if stream has not been
+     *  read to its end yet.
+     */
+    pointer index() const;
+
+    struct Detail;
+
+private:
+    std::shared_ptr<Detail> detail_;
+};
+
+/** Seekable input device reading uncompressed data via index. Seek is cheap,
+ *  the nearest checkpoint is used on the next read.
+ */
+class InflateIndex::Device {
+public:
+    typedef char char_type;
+    struct category : boost::iostreams::device_tag
+                    , boost::iostreams::input_seekable {};
+
+    Device(const pointer &index, const Source &source);
+
+    std::streamsize read(char *data, std::streamsize size);
+
+    std::streampos seek(boost::iostreams::stream_offset off
+                        , std::ios_base::seekdir way);
+
+    struct Detail;
+
+private:
+    std::shared_ptr<Detail> detail_;
+};
+
+} // namespace utility
+
+#endif // utility_inflate_index_hpp_included_
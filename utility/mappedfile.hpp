@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef utility_mappedfile_hpp_included_
+#define utility_mappedfile_hpp_included_
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "filedes.hpp"
+
+namespace utility {
+
+/** Read-only view into memory. Viewed memory is kept alive by the owner.
+ */
+struct MemoryView {
+    const char *data;
+    std::size_t size;
+    std::shared_ptr<const void> owner;
+
+    MemoryView() : data(), size() {}
+
+    MemoryView(const char *data, std::size_t size
+               , std::shared_ptr<const void> owner = {})
+        : data(data), size(size), owner(std::move(owner))
+    {}
+
+    const char* begin() const { return data; }
+    const char* end() const { return data + size; }
+    bool empty() const { return !size; }
+};
+
+/** Read-only shared memory mapping of a file.
+ *
+ *  Must be held by a shared pointer if view() is used.
+ */
+class MappedFile
+    : boost::noncopyable
+    , public std::enable_shared_from_this<MappedFile>
+{
+public:
+    typedef std::shared_ptr<MappedFile> pointer;
+
+    enum class Advice { normal, sequential, random, willNeed, dontNeed };
+
+    /** Maps whole file. Empty file is valid and maps to no memory.
+     */
+    MappedFile(const Filedes &fd);
+
+    /** Maps first size bytes of file.
+     */
+    MappedFile(const Filedes &fd, std::size_t size);
+
+    ~MappedFile();
+
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const boost::filesystem::path& path() const { return path_; }
+
+    /** Gives the kernel a hint about expected access to given range of the
+     *  mapping. Failure is not fatal, it is only logged.
+     */
+    void advise(Advice advice, std::size_t offset = 0
+                , std::size_t size = std::numeric_limits<std::size_t>::max())
+        const;
+
+    /** Returns view of given range. Range is trimmed to mapping. View keeps
+     *  this mapping alive.
+     */
+    MemoryView view(std::size_t offset = 0
+                    , std::size_t size = std::numeric_limits<std::size_t>::max())
+        const;
+
+    /** Maps whole file.
+     */
+    static pointer map(const Filedes &fd);
+
+private:
+    void map(int fd, std::size_t size);
+
+    boost::filesystem::path path_;
+    const char *data_;
+    std::size_t size_;
+};
+
+// inlines
+
+inline MappedFile::pointer MappedFile::map(const Filedes &fd)
+{
+    return std::make_shared<MappedFile>(fd);
+}
+
+inline MemoryView MappedFile::view(std::size_t offset, std::size_t size)
+    const
+{
+    if (offset > size_) { offset = size_; }
+    if (size > (size_ - offset)) { size = size_ - offset; }
+    return { data_ + offset, size, shared_from_this() };
+}
+
+} // namespace utility
+
+#endif // utility_mappedfile_hpp_included_
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_parallel_hpp_included_
+#define utility_parallel_hpp_included_
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+
+#include "cpuinfo.hpp"
+
+namespace utility {
+
+/** Runs fn(i) for i in [0, count) on given number of threads (0 means number
+ *  of CPUs). Indices are handed out dynamically, one at a time. First
+ *  exception thrown by fn stops processing and is rethrown in the calling
+ *  thread.
+ */
+template <typename Function>
+void parallelFor(std::size_t count, std::size_t threads
+                 , const Function &fn)
+{
+    if (!threads) { threads = utility::cpuCount(); }
+    if (threads > count) { threads = count; }
+
+    if (threads <= 1) {
+        for (std::size_t i(0); i != count; ++i) { fn(i); }
+        return;
+    }
+
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> stop(false);
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    auto worker([&]() -> void
+    {
+        try {
+            while (!stop) {
+                const auto i(next++);
+                if (i >= count) { break; }
+                fn(i);
+            }
+        } catch (...) {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!error) { error = std::current_exception(); }
+            stop = true;
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for (std::size_t i(0); i != threads; ++i) {
+        workers.emplace_back(worker);
+    }
+    for (auto &thread : workers) { thread.join(); }
+
+    if (error) { std::rethrow_exception(error); }
+}
+
+} // namespace utility
+
+#endif // utility_parallel_hpp_included_
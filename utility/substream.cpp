@@ -77,6 +77,10 @@ SubStreamDevice::read_impl(char *data, std::streamsize size
 
     if (!size) { return size; }
 
+    if (cache_) {
+        return cache_->read(fd_.fd, key_, data, size, pos, path_);
+    }
+
     auto bytes(::pread(fd_.fd, data, size, pos));
     if (-1 == bytes) {
         std::system_error e
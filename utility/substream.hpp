@@ -33,6 +33,8 @@
 #include <boost/iostreams/categories.hpp>
 #include <boost/iostreams/positioning.hpp>
 
+#include "block-cache.hpp"
+
 namespace utility { namespace io {
 
 /** Input device for part of file. Can be pointed at any point.
@@ -55,6 +57,25 @@ struct SubStreamDevice {
         : path_(path), fd_(fd), pos_(fd.start)
     {}
 
+    /** Reads data through given block cache. File identity is obtained from
+     *  the descriptor (one fstat).
+     */
+    SubStreamDevice(const boost::filesystem::path &path
+                    , const Filedes &fd, const BlockCache::pointer &cache)
+        : path_(path), fd_(fd), pos_(fd.start), cache_(cache)
+    {
+        if (cache_) { key_ = BlockCache::key(fd.fd, path); }
+    }
+
+    /** Reads data through given block cache. File identity is supplied by
+     *  caller (see BlockCache::key()).
+     */
+    SubStreamDevice(const boost::filesystem::path &path
+                    , const Filedes &fd, const BlockCache::pointer &cache
+                    , const BlockCache::FileKey &key)
+        : path_(path), fd_(fd), pos_(fd.start), cache_(cache), key_(key)
+    {}
+
     std::streampos seek(boost::iostreams::stream_offset off
                         , std::ios_base::seekdir way);
 
@@ -83,6 +104,11 @@ private:
     boost::filesystem::path path_;
     Filedes fd_;
     boost::iostreams::stream_offset pos_;
+
+    /** Optional block cache.
+     */
+    BlockCache::pointer cache_;
+    BlockCache::FileKey key_ = {};
 };
 
 } } // namespace utility::io
@@ -0,0 +1,255 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fcntl.h>
+
+#include <algorithm>
+#include <fstream>
+#include <system_error>
+
+#include <boost/filesystem.hpp>
+
+#include "utility/unistd_compat.hpp"
+#include "dbglog/dbglog.hpp"
+
+#include "tar-gz.hpp"
+#include "filesystem.hpp"
+#include "binaryio.hpp"
+#include "detail/sidecar.hpp"
+
+namespace utility { namespace tar {
+
+namespace fs = boost::filesystem;
+namespace bin = utility::binaryio;
+
+namespace {
+
+const char IndexMagic[8] = { 'T', 'A', 'R', 'G', 'Z', 'I', 'X', '2' };
+
+/** Reads up to size bytes from builder. Returns number of bytes read, less
+ *  than size only at the end of data.
+ */
+std::size_t readFully(InflateIndex::Builder &builder, char *data
+                      , std::size_t size)
+{
+    std::size_t total(0);
+    while (total < size) {
+        const auto bytes(builder.read(data + total, size - total));
+        if (bytes < 0) { break; }
+        total += bytes;
+    }
+    return total;
+}
+
+} // namespace
+
+GzipReader::GzipReader(const fs::path &path, std::size_t span)
+    : path_(path), fd_(::open(path.string().c_str(), O_RDONLY), path)
+{
+    if (!fd_) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot open tar file " << fd_.path() << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+
+    source_ = InflateIndex::source(fd_, 0, FileStat::from(fd_).size);
+
+    if (!loadIndex(indexPath())) { scan(span); }
+}
+
+void GzipReader::scan(std::size_t span)
+{
+    InflateIndex::Builder builder(source_, InflateIndex::Format::gzip, span);
+
+    Data scratch(1 << 16);
+    const auto skip([&](std::uint64_t size) -> void
+    {
+        while (size) {
+            const auto chunk(std::min(std::uint64_t(scratch.size()), size));
+            if (readFully(builder, scratch.data(), chunk) != chunk) {
+                LOGTHROW(err2, std::runtime_error)
+                    << "Tar file " << path_ << " is truncated.";
+            }
+            size -= chunk;
+        }
+    });
+
+    // offset in uncompressed data
+    std::uint64_t offset(0);
+    PaxOverrides pax;
+    Header header;
+
+    for (;;) {
+        const auto bytes(readFully(builder, header.data.data()
+                                   , header.data.size()));
+        if (!bytes) { break; }
+        if (bytes != header.data.size()) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Short read from tar file " << path_ << ".";
+        }
+        offset += bytes;
+
+        if (!header.valid()) {
+            continue;
+        }
+
+        if (header.isPaxExtended()) {
+            Data data(header.getSize());
+            if (readFully(builder, data.data(), data.size()) != data.size()) {
+                LOGTHROW(err2, std::runtime_error)
+                    << "Tar file " << path_ << " is truncated.";
+            }
+            pax.parse(data.data(), data.size());
+            skip(header.getBlocksBytes() - data.size());
+            offset += header.getBlocksBytes();
+            continue;
+        }
+
+        const auto size(pax.getSize(header));
+
+        if (header.isFile()) {
+            files_.emplace_back(pax.getPath(header), offset, size);
+        }
+
+        // skip file/whatever content
+        const auto padded(((size + 511UL) / 512UL) * 512UL);
+        skip(padded);
+        offset += padded;
+
+        pax.reset();
+    }
+
+    index_ = builder.index();
+}
+
+Data GzipReader::readData(const Reader::File &file) const
+{
+    InflateIndex::Device device(index_, source_);
+    device.seek(file.start, std::ios_base::beg);
+
+    Data data(file.size);
+    std::size_t total(0);
+    while (total < data.size()) {
+        const auto bytes(device.read(data.data() + total
+                                     , data.size() - total));
+        if (bytes <= 0) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Too few data in " << path_ << " at position "
+                << file.start << ".";
+        }
+        total += bytes;
+    }
+
+    return data;
+}
+
+fs::path GzipReader::indexPath() const
+{
+    return path_.string() + ".gzidx";
+}
+
+void GzipReader::saveIndex(const fs::path &path) const
+{
+    const auto key(FileKey::from(fd_));
+
+    try {
+        writeFileAtomically(path, [&](std::ostream &f)
+        {
+            utility::detail::writeSidecarHeader(f, IndexMagic, key);
+            bin::write(f, std::uint64_t(files_.size()));
+
+            for (const auto &file : files_) {
+                const auto path(file.path.string());
+                bin::write(f, std::uint64_t(file.start));
+                bin::write(f, std::uint64_t(file.size));
+                bin::write(f, std::uint64_t(path.size()));
+                bin::write(f, path.data(), path.size());
+            }
+
+            index_->save(f);
+        });
+    } catch (const std::exception &e) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Cannot save index of tar file " << path_
+            << " to " << path << ": " << e.what();
+    }
+}
+
+bool GzipReader::loadIndex(const fs::path &path)
+{
+    std::ifstream f;
+    f.open(path.string(), std::ios_base::in | std::ios_base::binary);
+    if (!f) { return false; }
+
+    Reader::File::list files;
+    InflateIndex::pointer index;
+    try {
+        const auto key(FileKey::from(fd_));
+        if (!utility::detail::readSidecarHeader
+            (f, IndexMagic, key, path, "tar.gz index"))
+        {
+            return false;
+        }
+
+        auto count(bin::read<std::uint64_t>(f));
+        while (f && count--) {
+            const auto start(bin::read<std::uint64_t>(f));
+            const auto fileSize(bin::read<std::uint64_t>(f));
+            const auto pathSize(bin::read<std::uint64_t>(f));
+            if (!f) { break; }
+            if (pathSize > key.size) {
+                LOG(warn2) << "Tar.gz index " << path << " is corrupted.";
+                return false;
+            }
+
+            std::string filePath(pathSize, '\0');
+            bin::read(f, &filePath[0], filePath.size());
+            files.emplace_back(filePath, start, fileSize);
+        }
+
+        if (!f) {
+            LOG(warn2) << "Tar.gz index " << path << " is truncated.";
+            return false;
+        }
+
+        index = InflateIndex::load(f);
+    } catch (const std::exception &e) {
+        LOG(warn2) << "Cannot load tar.gz index " << path << ": "
+                   << e.what();
+        return false;
+    }
+
+    if (index->format() != InflateIndex::Format::gzip) {
+        LOG(warn2) << "Tar.gz index " << path << " is not a gzip index.";
+        return false;
+    }
+
+    files_ = std::move(files);
+    index_ = std::move(index);
+    return true;
+}
+
+} } // namespace utility::tar
@@ -0,0 +1,103 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_tar_gz_hpp_included_
+#define utility_tar_gz_hpp_included_
+
+#include <cstddef>
+
+#include <boost/filesystem/path.hpp>
+
+#include "tar.hpp"
+#include "inflate-index.hpp"
+#include "filedes.hpp"
+
+namespace utility { namespace tar {
+
+/** Random access reader of gzip compressed tar archives (.tar.gz, .tgz).
+ *
+ *  Archive is decompressed once while its headers are scanned; at the same
+ *  time a checkpoint index (see utility::InflateIndex) is built. Member data
+ *  are then read by inflating from the nearest preceding checkpoint, i.e. at
+ *  most `span` bytes of unneeded data are decompressed per read.
+ *
+ *  Both member list and checkpoint index can be persisted next to the
+ *  archive (see saveIndex()) so later opens skip the scan completely.
+ *
+ *  File offsets (Reader::File::start) are offsets in uncompressed data.
+ */
+class GzipReader {
+public:
+    /** Opens archive. Loads persisted index from indexPath() if present and
+     *  valid, scans whole archive otherwise.
+     *
+     * \param path path to archive
+     * \param span distance between checkpoints in uncompressed data
+     */
+    GzipReader(const boost::filesystem::path &path
+               , std::size_t span = InflateIndex::DefaultSpan);
+
+    /** Archive members.
+     */
+    const Reader::File::list& files() const { return files_; }
+
+    /** Reads data of given member. Thread safe.
+     */
+    Data readData(const Reader::File &file) const;
+
+    /** Checkpoint index of uncompressed data.
+     */
+    const InflateIndex::pointer& index() const { return index_; }
+
+    /** Default location of persisted index: archive path with ".gzidx"
+     *  appended.
+     */
+    boost::filesystem::path indexPath() const;
+
+    /** Saves member list and checkpoint index to given file.
+     */
+    void saveIndex(const boost::filesystem::path &path) const;
+
+    /** Saves member list and checkpoint index next to the archive.
+     */
+    void saveIndex() const { saveIndex(indexPath()); }
+
+    const boost::filesystem::path& path() const { return path_; }
+
+private:
+    void scan(std::size_t span);
+
+    bool loadIndex(const boost::filesystem::path &path);
+
+    boost::filesystem::path path_;
+    utility::Filedes fd_;
+    InflateIndex::Source source_;
+    Reader::File::list files_;
+    InflateIndex::pointer index_;
+};
+
+} } // namespace utility::tar
+
+#endif // utility_tar_gz_hpp_included_
@@ -0,0 +1,293 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <fcntl.h>
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <system_error>
+
+#include <boost/filesystem.hpp>
+
+#include "utility/unistd_compat.hpp"
+#include "dbglog/dbglog.hpp"
+
+#include "tar-index.hpp"
+
+namespace utility { namespace tar {
+
+namespace fs = boost::filesystem;
+
+/** On-disk index entry.
+ */
+struct Index::Entry {
+    std::uint64_t start;
+    std::uint64_t size;
+    std::uint64_t pathOffset;
+    std::uint64_t pathLength;
+};
+
+namespace {
+
+const char IndexMagic[8] = { 'T', 'A', 'R', 'I', 'D', 'X', '0', '2' };
+
+const std::uint32_t ByteOrderMark(0x01020304);
+
+/** On-disk index header, followed by entries and path strings.
+ */
+struct IndexHeader {
+    char magic[sizeof(IndexMagic)];
+    std::uint32_t byteOrder;
+    std::uint32_t entrySize;
+    std::uint64_t archiveDev;
+    std::uint64_t archiveIno;
+    std::uint64_t archiveSize;
+    std::int64_t archiveModified;
+    std::int64_t archiveChanged;
+    std::uint64_t count;
+    std::uint64_t stringsSize;
+};
+
+std::string serialize(const Reader::File::list &files
+                      , const FileKey &archive)
+{
+    // sort by path, keep archive order for duplicates
+    std::vector<std::string> paths;
+    paths.reserve(files.size());
+    for (const auto &file : files) { paths.push_back(file.path.string()); }
+
+    std::vector<std::size_t> order(files.size());
+    for (std::size_t i(0); i < order.size(); ++i) { order[i] = i; }
+    std::stable_sort(order.begin(), order.end()
+                     , [&](std::size_t l, std::size_t r) {
+                         return paths[l] < paths[r];
+                     });
+
+    IndexHeader header;
+    std::memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+    header.byteOrder = ByteOrderMark;
+    header.entrySize = sizeof(Index::Entry);
+    header.archiveDev = archive.dev;
+    header.archiveIno = archive.ino;
+    header.archiveSize = archive.size;
+    header.archiveModified = archive.modified;
+    header.archiveChanged = archive.changed;
+    header.count = files.size();
+    header.stringsSize = 0;
+    for (const auto &path : paths) { header.stringsSize += path.size(); }
+
+    std::string out;
+    out.reserve(sizeof(header) + files.size() * sizeof(Index::Entry)
+                + header.stringsSize);
+    out.append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::uint64_t pathOffset(0);
+    for (const auto i : order) {
+        const Index::Entry entry
+            = { files[i].start, files[i].size, pathOffset, paths[i].size() };
+        out.append(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        pathOffset += paths[i].size();
+    }
+
+    for (const auto i : order) { out.append(paths[i]); }
+
+    return out;
+}
+
+} // namespace
+
+Index::Index(const MemoryView &memory)
+    : memory_(memory)
+    , entries_(reinterpret_cast<const Entry*>
+               (memory.data + sizeof(IndexHeader)))
+    , strings_(), count_()
+{
+    const auto *header(reinterpret_cast<const IndexHeader*>(memory.data));
+    count_ = header->count;
+    strings_ = memory.data + sizeof(IndexHeader) + count_ * sizeof(Entry);
+}
+
+Index::pointer Index::parse(const MemoryView &memory, const FileKey &archive
+                            , const fs::path &path)
+{
+    if (memory.size < sizeof(IndexHeader)) {
+        LOG(warn2) << "Tar index " << path << " is truncated.";
+        return {};
+    }
+
+    const auto *header(reinterpret_cast<const IndexHeader*>(memory.data));
+    if (std::memcmp(header->magic, IndexMagic, sizeof(IndexMagic))) {
+        LOG(warn2) << "File " << path << " is not a tar index.";
+        return {};
+    }
+
+    if ((header->byteOrder != ByteOrderMark)
+        || (header->entrySize != sizeof(Entry)))
+    {
+        LOG(warn2) << "Tar index " << path
+                   << " was written on incompatible platform.";
+        return {};
+    }
+
+    if ((header->archiveDev != archive.dev)
+        || (header->archiveIno != archive.ino)
+        || (header->archiveSize != archive.size)
+        || (header->archiveModified != archive.modified)
+        || (header->archiveChanged != archive.changed))
+    {
+        LOG(info2) << "Tar index " << path << " is stale.";
+        return {};
+    }
+
+    const auto available(memory.size - sizeof(IndexHeader));
+    if ((header->count > (available / sizeof(Entry)))
+        || ((available - header->count * sizeof(Entry))
+            != header->stringsSize))
+    {
+        LOG(warn2) << "Tar index " << path << " is corrupted.";
+        return {};
+    }
+
+    return pointer(new Index(memory));
+}
+
+boost::string_view Index::path(const Entry &entry) const
+{
+    const auto *header(reinterpret_cast<const IndexHeader*>(memory_.data));
+
+    // checked lazily to keep load time independent of index size
+    if ((entry.pathOffset > header->stringsSize)
+        || (entry.pathLength > (header->stringsSize - entry.pathOffset)))
+    {
+        LOGTHROW(err2, std::runtime_error)
+            << "Corrupted tar index entry.";
+    }
+
+    return { strings_ + entry.pathOffset, std::size_t(entry.pathLength) };
+}
+
+Reader::File Index::file(std::size_t index) const
+{
+    if (index >= count_) {
+        LOGTHROW(err2, std::out_of_range)
+            << "Invalid tar index entry " << index << ".";
+    }
+
+    const auto &entry(entries_[index]);
+    return { path(entry).to_string(), std::size_t(entry.start)
+             , std::size_t(entry.size) };
+}
+
+boost::optional<Reader::File> Index::find(const std::string &path) const
+{
+    const boost::string_view key(path);
+
+    // first entry greater than key, match (if any) is right before it
+    const auto end(entries_ + count_);
+    const auto ientries
+        (std::upper_bound(entries_, end, key
+                          , [&](const boost::string_view &key
+                                , const Entry &entry)
+                          {
+                              return key < this->path(entry);
+                          }));
+
+    if (ientries == entries_) { return boost::none; }
+    if (this->path(*std::prev(ientries)) != key) { return boost::none; }
+
+    return file(std::prev(ientries) - entries_);
+}
+
+Reader::File::list Index::files() const
+{
+    Reader::File::list files;
+    files.reserve(count_);
+    for (std::size_t i(0); i < count_; ++i) { files.push_back(file(i)); }
+    return files;
+}
+
+void Index::save(const fs::path &path, const Reader::File::list &files
+                 , const FileKey &archive)
+{
+    const auto data(serialize(files, archive));
+
+    try {
+        writeFileAtomically(path, [&](std::ostream &f)
+        {
+            f.write(data.data(), data.size());
+        });
+    } catch (const std::exception &e) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Cannot save tar index to " << path << ": " << e.what();
+    }
+}
+
+Index::pointer Index::load(const fs::path &path, const FileKey &archive)
+{
+    utility::Filedes fd(::open(path.string().c_str(), O_RDONLY), path);
+    if (!fd) {
+        if (errno != ENOENT) {
+            std::system_error e(errno, std::system_category());
+            LOG(warn2) << "Cannot open tar index " << path << ": <"
+                       << e.code() << ", " << e.what() << ">.";
+        }
+        return {};
+    }
+
+    try {
+        const auto mapping(MappedFile::map(fd));
+        mapping->advise(MappedFile::Advice::random);
+        return parse(mapping->view(), archive, path);
+    } catch (const std::exception &e) {
+        LOG(warn2) << "Cannot load tar index " << path << ": " << e.what();
+    }
+    return {};
+}
+
+Index::pointer Index::open(Reader &reader)
+{
+    const auto archive(FileKey::from(reader.filedes()));
+    const auto path(defaultPath(reader.path()));
+
+    if (auto index = load(path, archive)) { return index; }
+
+    LOG(info1) << "Indexing tar file " << reader.path() << ".";
+    const auto files(reader.files());
+
+    try {
+        save(path, files, archive);
+        if (auto index = load(path, archive)) { return index; }
+    } catch (const std::exception &e) {
+        LOG(warn2) << "Cannot save tar index " << path << ": " << e.what()
+                   << "; keeping index in memory.";
+    }
+
+    const auto data(std::make_shared<std::string>(serialize(files, archive)));
+    return parse(MemoryView(data->data(), data->size(), data)
+                 , archive, path);
+}
+
+} } // namespace utility::tar
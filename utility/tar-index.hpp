@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_tar_index_hpp_included_
+#define utility_tar_index_hpp_included_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "tar.hpp"
+#include "mappedfile.hpp"
+#include "filesystem.hpp"
+
+namespace utility { namespace tar {
+
+/** Persistent tar archive index.
+ *
+ *  Index file holds member paths (sorted), data offsets and sizes together
+ *  with precise identity of indexed archive (see utility::FileKey). File is memory mapped
+ *  and used as is, i.e. opening an index costs the same regardless of
+ *  archive size. Lookup is a binary search over the mapped entries.
+ *
+ *  If index file cannot be written (e.g. read-only location) open() keeps
+ *  the index in memory.
+ *
+ *  Index file is stored in native byte order; index written on a machine
+ *  with different byte order is refused.
+ */
+class Index {
+public:
+    typedef std::shared_ptr<const Index> pointer;
+
+    /** Number of indexed members.
+     */
+    std::size_t size() const { return count_; }
+
+    /** Member at given index (members are sorted by path).
+     */
+    Reader::File file(std::size_t index) const;
+
+    /** Finds member by path. If path is present multiple times the last one
+     *  (i.e. the one that wins on extraction) is returned.
+     */
+    boost::optional<Reader::File> find(const std::string &path) const;
+
+    /** All members sorted by path.
+     */
+    Reader::File::list files() const;
+
+    /** Default location of index file: archive path with ".tidx" appended.
+     */
+    static boost::filesystem::path
+    defaultPath(const boost::filesystem::path &archive);
+
+    /** Writes index of given files belonging to archive with given key.
+     *  Index is written atomically, see utility::writeFileAtomically().
+     */
+    static void save(const boost::filesystem::path &path
+                     , const Reader::File::list &files
+                     , const FileKey &archive);
+
+    /** Maps index file. Returns null pointer if there is no such file or if
+     *  it doesn't belong to archive with given key (different file, size or
+     *  modification time) or is corrupted.
+     */
+    static pointer load(const boost::filesystem::path &path
+                        , const FileKey &archive);
+
+    /** Loads index from default location. If unavailable or stale, archive
+     *  is scanned, index is saved (failure is only logged) and loaded.
+     */
+    static pointer open(Reader &reader);
+
+    struct Entry;
+
+private:
+    Index(const MemoryView &memory);
+
+    static pointer parse(const MemoryView &memory, const FileKey &archive
+                         , const boost::filesystem::path &path);
+
+    boost::string_view path(const Entry &entry) const;
+
+    MemoryView memory_;
+    const Entry *entries_;
+    const char *strings_;
+    std::size_t count_;
+};
+
+// inlines
+
+inline boost::filesystem::path
+Index::defaultPath(const boost::filesystem::path &archive)
+{
+    return archive.string() + ".tidx";
+}
+
+} } // namespace utility::tar
+
+#endif // utility_tar_index_hpp_included_
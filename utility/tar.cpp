@@ -25,13 +25,24 @@
  */
 #include <sys/stat.h>
 #include <fcntl.h>
+#ifndef _WIN32
+#include <sys/uio.h>
+#include <limits.h>
+#endif
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
 #include <system_error>
 
+#include <boost/optional.hpp>
+
 #include "utility/unistd_compat.hpp"
 #include "dbglog/dbglog.hpp"
 
 #include "tar.hpp"
+#include "zerocopy.hpp"
 
 
 #ifdef _WIN32
@@ -46,6 +57,10 @@
 #include <tar.h>
 #endif
 
+#if !defined(_WIN32) && !defined(IOV_MAX)
+#define IOV_MAX 1024
+#endif
+
 
 namespace utility { namespace tar {
 
@@ -71,6 +86,110 @@ std::string getString(const char *v)
     return { v };
 }
 
+/** PAX extended header type flag.
+ */
+const char PaxExtendedType('x');
+
+/** Maximum member size representable in ustar header (11 octal digits).
+ */
+const std::uint64_t MaxUstarSize(077777777777ull);
+
+
+/** Reads archive blocks via large positional reads. Blocks are served from
+ *  internal window; window is refilled only when requested block lies
+ *  outside.
+ */
+class BlockScanner {
+public:
+    BlockScanner(const utility::Filedes &fd, std::size_t window)
+        : fd_(fd), buffer_(window), start_(), size_()
+    {}
+
+    /** Returns block at given byte offset or nullptr on EOF.
+     */
+    const char* block(std::uint64_t offset) {
+        if (!inside(offset, 512)) {
+            fill(offset);
+            if (!size_) { return nullptr; }
+            if (size_ < 512) {
+                LOGTHROW(err2, std::runtime_error)
+                    << "Short read from tar file " << fd_.path() << ".";
+            }
+        }
+        return buffer_.data() + (offset - start_);
+    }
+
+    /** Reads given amount of bytes at given byte offset.
+     */
+    Data read(std::uint64_t offset, std::size_t size) {
+        Data data(size);
+        if (inside(offset, size)) {
+            std::memcpy(data.data(), buffer_.data() + (offset - start_)
+                        , size);
+            return data;
+        }
+
+        if (pread(data.data(), size, offset) != size) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Too few data in " << fd_.path() << " at position "
+                << offset << ".";
+        }
+        return data;
+    }
+
+private:
+    bool inside(std::uint64_t offset, std::size_t size) const {
+        return ((offset >= start_) && ((offset + size) <= (start_ + size_)));
+    }
+
+    void fill(std::uint64_t offset) {
+        start_ = offset;
+        size_ = pread(buffer_.data(), buffer_.size(), offset);
+    }
+
+    /** Reads until buffer is full or EOF is hit.
+     */
+    std::size_t pread(char *data, std::size_t size, std::uint64_t offset) {
+        std::size_t total(0);
+        while (total < size) {
+            const auto bytes(TEMP_FAILURE_RETRY
+                             (::pread(fd_, data + total, size - total
+                                      , offset + total)));
+            if (bytes == -1) {
+                std::system_error e(errno, std::system_category());
+                LOG(err2) << "Cannot read from tar file " << fd_.path()
+                          << ": <" << e.code() << ", " << e.what() << ">.";
+                throw e;
+            }
+            if (!bytes) { break; }
+            total += bytes;
+        }
+        return total;
+    }
+
+    const utility::Filedes &fd_;
+    Data buffer_;
+    std::uint64_t start_;
+    std::size_t size_;
+};
+
+void adviseSequential(const utility::Filedes &fd, bool sequential)
+{
+#ifndef _WIN32
+    const auto res(::posix_fadvise(fd, 0, 0, sequential
+                                   ? POSIX_FADV_SEQUENTIAL
+                                   : POSIX_FADV_NORMAL));
+    if (res) {
+        std::system_error e(res, std::system_category());
+        LOG(warn1) << "Cannot advise on tar file " << fd.path() << ": <"
+                   << e.code() << ", " << e.what() << ">.";
+    }
+#else
+    (void) fd;
+    (void) sequential;
+#endif
+}
+
 } // namespace
 
 Type Header::type() const
@@ -107,6 +226,56 @@ bool Header::isFile() const {
     return (*typeflag() == REGTYPE) || (*typeflag() == AREGTYPE);
 }
 
+bool Header::isPaxExtended() const {
+    return (*typeflag() == PaxExtendedType);
+}
+
+void Header::updateChecksum()
+{
+    // checksum is computed with checksum field filled with spaces
+    std::memset(chksum(), ' ', 8);
+
+    unsigned int sum(0);
+    for (const auto c : Block::data) { sum += static_cast<unsigned char>(c); }
+
+    // six octal digits, NUL and space
+    std::snprintf(chksum(), 7, "%06o", sum);
+    chksum()[7] = ' ';
+}
+
+void PaxOverrides::parse(const char *data, std::size_t dataSize)
+{
+    const char *end(data + dataSize);
+    while (data < end) {
+        // record: "<length> <key>=<value>\n", length includes everything
+        char *e(nullptr);
+        const auto length(std::strtoul(data, &e, 10));
+        if (!length || (e == data) || (*e != ' ')
+            || (length > std::size_t(end - data)))
+        {
+            LOG(warn2) << "Malformed PAX extended header record.";
+            return;
+        }
+
+        const std::string record(static_cast<const char*>(e) + 1
+                                 , data + length - 1);
+        const auto eq(record.find('='));
+        if (eq != std::string::npos) {
+            const auto key(record.substr(0, eq));
+            if (key == "path") {
+                path = fs::path(record.substr(eq + 1));
+            } else if (key == "size") {
+                size = std::stoull(record.substr(eq + 1));
+            }
+        }
+
+        data += length;
+    }
+}
+
+constexpr std::size_t Reader::IndexReadSize;
+constexpr std::size_t Reader::BatchMaxGap;
+
 Reader::Reader(const fs::path &path)
     : path_(path), fd_(::open(path.string().c_str(), O_RDONLY), path)
     , cursor_(0)
@@ -119,6 +288,16 @@ Reader::Reader(const fs::path &path)
     }
 }
 
+Reader::Reader(const fs::path &path, bool mmap)
+    : Reader(path)
+{
+    if (!mmap) { return; }
+
+    mapping_ = MappedFile::map(fd_);
+    // headers and members are accessed randomly
+    mapping_->advise(MappedFile::Advice::random);
+}
+
 void Reader::seek(std::size_t blocks)
 {
     auto res(::lseek(fd_, blocks * 512, SEEK_SET));
@@ -200,6 +379,151 @@ Data Reader::readData(std::size_t block, std::size_t size)
     return data;
 }
 
+namespace {
+
+#ifndef _WIN32
+
+/** Reads whole iovec list at given offset, handles partial reads.
+ */
+void preadvAll(const utility::Filedes &fd, std::vector<::iovec> &iov
+               , std::uint64_t offset)
+{
+    auto *current(iov.data());
+    auto *end(iov.data() + iov.size());
+
+    while (current != end) {
+        const auto bytes(TEMP_FAILURE_RETRY
+                         (::preadv(fd, current, int(end - current)
+                                   , offset)));
+        if (bytes == -1) {
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Cannot read from tar file " << fd.path() << ": <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+
+        if (!bytes) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Too few data in " << fd.path() << " at offset "
+                << offset << ".";
+        }
+
+        offset += bytes;
+
+        // skip fully read buffers, adjust partially read one
+        std::size_t left(bytes);
+        while ((current != end) && (left >= current->iov_len)) {
+            left -= current->iov_len;
+            ++current;
+        }
+        if (left) {
+            current->iov_base = static_cast<char*>(current->iov_base) + left;
+            current->iov_len -= left;
+        }
+    }
+}
+
+#endif
+
+} // namespace
+
+std::vector<Data> Reader::readData(const File::list &files) const
+{
+    std::vector<Data> data;
+    data.reserve(files.size());
+    for (const auto &file : files) { data.emplace_back(file.size); }
+
+    if (mapping_) {
+        for (std::size_t i(0); i < files.size(); ++i) {
+            const auto v(view(files[i], MappedFile::Advice::normal));
+            std::copy(v.begin(), v.end(), data[i].begin());
+        }
+        return data;
+    }
+
+#ifndef _WIN32
+    // process files in archive order
+    std::vector<std::size_t> order;
+    for (std::size_t i(0); i < files.size(); ++i) {
+        if (files[i].size) { order.push_back(i); }
+    }
+    std::sort(order.begin(), order.end()
+              , [&](std::size_t l, std::size_t r) {
+                  return files[l].start < files[r].start;
+              });
+
+    // gaps between coalesced files are read here and thrown away
+    Data gap;
+    std::vector<::iovec> iov;
+
+    for (auto iorder(order.begin()); iorder != order.end(); ) {
+        const std::uint64_t start(files[*iorder].start);
+        std::uint64_t end(start);
+        iov.clear();
+
+        for (; iorder != order.end(); ++iorder) {
+            const auto &file(files[*iorder]);
+            if (!iov.empty()) {
+                // overlapping file or too far or out of iovecs -> next I/O
+                if ((file.start < end) || ((file.start - end) > BatchMaxGap)
+                    || ((iov.size() + 2) > IOV_MAX))
+                {
+                    break;
+                }
+
+                if (const auto skip = file.start - end) {
+                    if (gap.size() < skip) { gap.resize(BatchMaxGap); }
+                    iov.push_back({ gap.data(), std::size_t(skip) });
+                }
+            }
+
+            iov.push_back({ data[*iorder].data(), file.size });
+            end = file.start + file.size;
+        }
+
+        preadvAll(fd_, iov, start);
+    }
+#else
+    for (std::size_t i(0); i < files.size(); ++i) {
+        auto &d(data[i]);
+        if (TEMP_FAILURE_RETRY(::pread(fd_, d.data(), d.size()
+                                       , files[i].start))
+            != ::ssize_t(d.size()))
+        {
+            LOGTHROW(err2, std::runtime_error)
+                << "Too few data in " << fd_.path() << " at offset "
+                << files[i].start << ".";
+        }
+    }
+#endif
+
+    return data;
+}
+
+MemoryView Reader::view(std::size_t block, std::size_t size
+                        , MappedFile::Advice advice) const
+{
+    if (!mapping_) {
+        LOGTHROW(err2, std::logic_error)
+            << "Tar file " << fd_.path() << " is not memory mapped.";
+    }
+
+    const auto offset(block * 512);
+    if ((offset > mapping_->size()) || (size > (mapping_->size() - offset))) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Too few data in " << fd_.path() << " at position "
+            << block << ".";
+    }
+
+    if (size) { mapping_->advise(advice, offset, size); }
+    return mapping_->view(offset, size);
+}
+
+MemoryView Reader::view(const File &file, MappedFile::Advice advice) const
+{
+    return view(file.start / 512, file.size, advice);
+}
+
 Reader::Filedes Reader::filedes(std::size_t block, std::size_t size)
 {
     return { fd_.get(), std::size_t(block * 512)
@@ -208,51 +532,160 @@ Reader::Filedes Reader::filedes(std::size_t block, std::size_t size)
 
 /** Build index.
  */
-Reader::File::list Reader::files(std::size_t limit)
+Reader::File::list Reader::files(std::size_t limit, bool sequential)
 {
-    // rewind
-    seek(0);
+    if (sequential) { adviseSequential(fd_, true); }
 
     File::list files;
+    BlockScanner scanner(fd_, IndexReadSize);
+
+    // overrides from PAX extended header
+    PaxOverrides pax;
+
+    std::uint64_t offset(0);
+    Header header;
+    while (const auto *block = scanner.block(offset)) {
+        std::memcpy(header.data.data(), block, header.data.size());
+        offset += 512;
 
-    for (Header header; read(header); ) {
         if (!header.valid()) {
             continue;
         }
 
+        if (header.isPaxExtended()) {
+            const auto data(scanner.read(offset, header.getSize()));
+            pax.parse(data.data(), data.size());
+            offset += header.getBlocksBytes();
+            continue;
+        }
+
+        const auto size(pax.getSize(header));
+
         if (header.isFile()) {
-            std::size_t start(cursorByte());
-            files.emplace_back(header.getPath()
-                               , start, header.getSize());
+            files.emplace_back(pax.getPath(header), offset, size);
 
             // apply limit
             if (files.size() >= limit) { break; }
         }
 
         // skip file/whatever content
-        skip(header);
+        offset += ((size + 511UL) / 512UL) * 512UL;
+
+        pax.reset();
     }
 
+    if (sequential) { adviseSequential(fd_, false); }
+
+    // keep cursor consistent with scan
+    seek(offset / 512);
+
     return files;
 }
 
-#if 0
-// TODO: implement me
 namespace {
 
 int flagsToOpenFlags(int inflags)
 {
-    flags = O_WRONLY | O_APPEND;
+    if (inflags & Writer::Flags::extend) {
+        int flags(O_RDWR);
+        if (inflags & Writer::Flags::create) { flags |= O_CREAT; }
+        return flags;
+    }
+
+    int flags(O_WRONLY);
     if (inflags & Writer::Flags::truncate) { flags |= O_TRUNC; }
     if (inflags & Writer::Flags::create) { flags |= O_CREAT; }
     if (inflags & Writer::Flags::exclusive) { flags |= O_EXCL; }
+    return flags;
+}
+
+template <std::size_t size>
+void setOctal(char *field, std::uint64_t value)
+{
+    // zero padded octal number, size includes terminating NUL
+    field[size - 1] = '\0';
+    for (auto i(size - 1); i; --i, value >>= 3) {
+        field[i - 1] = char('0' + (value & 07));
+    }
+}
+
+void setString(char *field, std::size_t size, const std::string &value)
+{
+    std::memcpy(field, value.data(), std::min(size, value.size()));
+}
+
+Header ustarHeader(const std::string &name, const std::string &prefix
+                   , std::uint64_t size, std::time_t mtime
+                   , unsigned int mode, char type)
+{
+    Header header;
+    header.data.fill(0);
+
+    setString(header.name(), 100, name);
+    setString(header.prefix(), 155, prefix);
+    setOctal<8>(header.mode(), mode);
+    setOctal<8>(header.uid(), 0);
+    setOctal<8>(header.gid(), 0);
+    setOctal<12>(header.size(), size);
+    setOctal<12>(header.mtime(), (mtime > 0) ? mtime : 0);
+    *header.typeflag() = type;
+    std::memcpy(header.magic(), TMAGIC, TMAGLEN);
+    std::memcpy(header.version(), TVERSION, TVERSLEN);
+
+    header.updateChecksum();
+    return header;
 }
 
+/** Splits path into ustar prefix and name. Returns false if impossible.
+ */
+bool splitPath(const std::string &path, std::string &prefix
+               , std::string &name)
+{
+    if (path.size() <= 100) {
+        prefix.clear();
+        name = path;
+        return true;
+    }
+
+    // find first slash that leaves name short enough
+    for (auto slash(path.find('/')); slash != std::string::npos
+             ; slash = path.find('/', slash + 1))
+    {
+        if (slash > 155) { break; }
+        if ((path.size() - slash - 1) <= 100) {
+            prefix = path.substr(0, slash);
+            name = path.substr(slash + 1);
+            return !name.empty();
+        }
+    }
+
+    return false;
+}
+
+std::string paxRecord(const std::string &key, const std::string &value)
+{
+    const auto body(" " + key + "=" + value + "\n");
+
+    // record length includes its own decimal representation
+    auto length(body.size());
+    for (;;) {
+        const auto total(std::to_string(length).size() + body.size());
+        if (total == length) { break; }
+        length = total;
+    }
+
+    return std::to_string(length) + body;
+}
+
+const std::array<char, 1024> zeros = {};
+
 } // namespace
 
 Writer::Writer(const boost::filesystem::path &path, int flags)
-    : path_(path), fd_(::open(path.string().c_str(), flagsToOpenFlags(flags))
+    : path_(path), fd_(::open(path.string().c_str(), flagsToOpenFlags(flags)
+                              , (S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH))
                        , path)
+    , position_(), remaining_(), streamed_(), ended_(false)
 {
     if (!fd_) {
         std::system_error e(errno, std::system_category());
@@ -262,18 +695,267 @@ Writer::Writer(const boost::filesystem::path &path, int flags)
         throw e;
     }
 
-    // TODO: handle 
+    if (!(flags & Flags::extend)) { return; }
+
+    // find end of existing archive, i.e. first zero/missing block
+    BlockScanner scanner(fd_, Reader::IndexReadSize);
+    PaxOverrides pax;
+    Header header;
+    while (const auto *block = scanner.block(position_)) {
+        if (!std::memcmp(block, zeros.data(), 512)) { break; }
+
+        std::memcpy(header.data.data(), block, header.data.size());
+        if (!header.valid()) {
+            LOGTHROW(err2, std::runtime_error)
+                << "Cannot append to " << fd_.path()
+                << ": not a tar archive.";
+        }
+
+        if (header.isPaxExtended()) {
+            const auto data(scanner.read(position_ + 512, header.getSize()));
+            pax.parse(data.data(), data.size());
+            position_ += 512 + header.getBlocksBytes();
+            continue;
+        }
+
+        const auto size(pax.getSize(header));
+        position_ += 512 + ((size + 511UL) / 512UL) * 512UL;
+        pax.reset();
+    }
+
+    // last member must be complete, do not pad truncated archive with zeros
+    struct ::stat st;
+    if (-1 == ::fstat(fd_, &st)) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot stat tar file " << fd_.path() << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+
+    if (position_ > std::uint64_t(st.st_size)) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Cannot append to " << fd_.path()
+            << ": last member is truncated.";
+    }
+
+    // new members overwrite the terminator
+    if (::lseek(fd_, position_, SEEK_SET) == -1) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot seek in tar file " << fd_.path() << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+
+    // drop old terminator and anything past it
+    if (::ftruncate(fd_, position_) == -1) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot truncate tar file " << fd_.path() << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
 }
 
-void Writer::write(const Header &header, std::size_t block, std::size_t size)
+Writer::Writer(utility::Filedes &&fd)
+    : path_(fd.path()), fd_(std::move(fd))
+    , position_(), remaining_(), streamed_(), ended_(false)
 {
-    
+    // start at current position; non-seekable outputs start at zero
+    const auto pos(::lseek(fd_, 0, SEEK_CUR));
+    if (pos > 0) { position_ = pos; }
 }
 
-void Writer::write(const Header &header, const boost::filesystem &file)
+Writer::~Writer()
 {
-    
+    if (!ended_) {
+        LOG(warn2) << "Tar file " << path_ << " was not terminated. "
+                   << "Use end() member function.";
+    }
+}
+
+void Writer::checkIdle() const
+{
+    if (ended_) {
+        LOGTHROW(err2, std::logic_error)
+            << "Tar file " << path_ << " is already terminated.";
+    }
+
+    if (remaining_) {
+        LOGTHROW(err2, std::logic_error)
+            << "Tar file " << path_ << ": streamed member is missing "
+            << remaining_ << " bytes.";
+    }
+}
+
+void Writer::writeRaw(const void *data, std::size_t size)
+{
+    auto p(static_cast<const char*>(data));
+    while (size) {
+        const auto bytes(TEMP_FAILURE_RETRY(::write(fd_, p, size)));
+        if (bytes == -1) {
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Cannot write to tar file " << path_ << ": <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+        p += bytes;
+        size -= bytes;
+        position_ += bytes;
+    }
+}
+
+void Writer::pad(std::size_t size)
+{
+    if (const auto tail = size % 512) { writeRaw(zeros.data(), 512 - tail); }
+}
+
+void Writer::writeHeaders(const boost::filesystem::path &archivePath
+                          , std::size_t size, std::time_t mtime
+                          , unsigned int mode)
+{
+    auto path(archivePath.generic_string());
+    while (!path.empty() && (path.front() == '/')) { path.erase(0, 1); }
+
+    std::string records;
+    std::string prefix, name;
+    if (!splitPath(path, prefix, name)) {
+        records += paxRecord("path", path);
+        prefix.clear();
+        name = path.substr(path.size() - std::min(path.size()
+                                                  , std::size_t(100)));
+    }
+
+    const bool bigSize(size > MaxUstarSize);
+    if (bigSize) {
+        records += paxRecord("size", std::to_string(size));
+    }
+
+    if (!records.empty()) {
+        const auto pax(ustarHeader(("PaxHeaders/" + name).substr(0, 100), ""
+                                   , records.size(), mtime, 0644
+                                   , PaxExtendedType));
+        writeRaw(pax.data.data(), pax.data.size());
+        writeRaw(records.data(), records.size());
+        pad(records.size());
+    }
+
+    const auto header(ustarHeader(name, prefix, bigSize ? 0 : size, mtime
+                                  , mode, REGTYPE));
+    writeRaw(header.data.data(), header.data.size());
+}
+
+void Writer::write(const Header &header, const void *data, std::size_t size)
+{
+    checkIdle();
+
+    if (header.getSize() != size) {
+        LOGTHROW(err2, std::logic_error)
+            << "Tar header size " << header.getSize()
+            << " doesn't match data size " << size << ".";
+    }
+
+    writeRaw(header.data.data(), header.data.size());
+    writeRaw(data, size);
+    pad(size);
+}
+
+namespace {
+
+utility::Filedes openInput(const fs::path &file, struct ::stat &st)
+{
+    utility::Filedes fd(::open(file.string().c_str(), O_RDONLY), file);
+    if (!fd || (-1 == ::fstat(fd, &st))) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot open file " << file << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+
+    if (!S_ISREG(st.st_mode)) {
+        LOGTHROW(err2, std::runtime_error)
+            << "Cannot add " << file << " to tar: not a regular file.";
+    }
+
+    return fd;
+}
+
+} // namespace
+
+void Writer::write(const Header &header, const boost::filesystem::path &file)
+{
+    checkIdle();
+
+    struct ::stat st;
+    const auto src(openInput(file, st));
+    const std::size_t size(st.st_size);
+
+    if (header.getSize() != size) {
+        LOGTHROW(err2, std::logic_error)
+            << "Tar header size " << header.getSize()
+            << " doesn't match size " << size << " of file " << file << ".";
+    }
+
+    writeRaw(header.data.data(), header.data.size());
+    copyRange(src, 0, size, fd_);
+    position_ += size;
+    pad(size);
+}
+
+void Writer::add(const boost::filesystem::path &file
+                 , const boost::filesystem::path &archivePath)
+{
+    checkIdle();
+
+    struct ::stat st;
+    const auto src(openInput(file, st));
+    const std::size_t size(st.st_size);
+
+    writeHeaders(archivePath, size, st.st_mtime, st.st_mode & 07777);
+    copyRange(src, 0, size, fd_);
+    position_ += size;
+    pad(size);
+}
+
+void Writer::add(const boost::filesystem::path &archivePath
+                 , const void *data, std::size_t size, std::time_t mtime)
+{
+    checkIdle();
+
+    writeHeaders(archivePath, size, mtime, 0644);
+    writeRaw(data, size);
+    pad(size);
+}
+
+void Writer::begin(const boost::filesystem::path &archivePath
+                   , std::size_t size, std::time_t mtime)
+{
+    checkIdle();
+
+    writeHeaders(archivePath, size, mtime, 0644);
+    remaining_ = streamed_ = size;
+}
+
+void Writer::append(const void *data, std::size_t size)
+{
+    if (size > remaining_) {
+        LOGTHROW(err2, std::logic_error)
+            << "Tar file " << path_ << ": too much data for streamed member ("
+            << size << " bytes, " << remaining_ << " expected).";
+    }
+
+    writeRaw(data, size);
+    remaining_ -= size;
+
+    // last piece, finish member
+    if (!remaining_) { pad(streamed_); }
+}
+
+void Writer::end()
+{
+    checkIdle();
+
+    // two zero blocks
+    writeRaw(zeros.data(), zeros.size());
+    ended_ = true;
 }
-#endif
 
 } } // namespace utility::tar
@@ -27,12 +27,16 @@
 #define utility_tar_hpp_included_
 
 #include <ctime>
+#include <cstdint>
 #include <array>
+#include <vector>
 #include <limits>
 
+#include <boost/optional.hpp>
 #include <boost/filesystem/path.hpp>
 
 #include "filedes.hpp"
+#include "mappedfile.hpp"
 
 namespace utility { namespace tar {
 
@@ -109,17 +113,53 @@ struct Header : Block {
 
     bool isFile() const;
 
+    /** PAX extended header (applies to the next header).
+     */
+    bool isPaxExtended() const;
+
     std::time_t getTime() const;
+
+    /** Computes and stores header checksum.
+     */
+    void updateChecksum();
 };
 
 typedef std::vector<char> Data;
 
+/** Values from PAX extended header overriding fields of the next header.
+ */
+struct PaxOverrides {
+    boost::optional<boost::filesystem::path> path;
+    boost::optional<std::size_t> size;
+
+    /** Parses PAX extended header records (data of 'x' member).
+     */
+    void parse(const char *data, std::size_t size);
+
+    boost::filesystem::path getPath(const Header &header) const {
+        return path ? *path : header.getPath();
+    }
+
+    std::size_t getSize(const Header &header) const {
+        return size ? *size : header.getSize();
+    }
+
+    /** Call after the overridden header has been processed.
+     */
+    void reset() { path = boost::none; size = boost::none; }
+};
+
 class Reader {
 public:
     Reader() : cursor_() {}
 
     Reader(const boost::filesystem::path &path);
 
+    /** Opens archive. If mmap is true the whole archive is memory mapped and
+     *  member data are available as views (see view()) without any copy.
+     */
+    Reader(const boost::filesystem::path &path, bool mmap);
+
     void seek(std::size_t blocks);
 
     void advance(std::size_t blocks);
@@ -140,6 +180,20 @@ public:
      */
     Data readData(std::size_t block, std::size_t size);
 
+    /** Returns read-only view of given amount of bytes starting at given
+     *  block number. Available only in mmap mode. View keeps the mapping
+     *  alive. Kernel is given a hint about expected access to the range.
+     *
+     *  Thread safe (doesn't use cursor).
+     */
+    MemoryView view(std::size_t block, std::size_t size
+                    , MappedFile::Advice advice
+                    = MappedFile::Advice::willNeed) const;
+
+    /** Is archive memory mapped?
+     */
+    bool mapped() const { return bool(mapping_); }
+
     /** Simple structure for file descriptor and block start/end.
      */
     struct Filedes {
@@ -170,8 +224,46 @@ public:
         {}
     };
 
+    /** Returns read-only view of given file's data. See view() above.
+     */
+    MemoryView view(const File &file
+                    , MappedFile::Advice advice
+                    = MappedFile::Advice::willNeed) const;
+
+    /** Reads data of all given files at once. Result is in the same order
+     *  as input.
+     *
+     *  Files are read via positional vectored reads (preadv). Files lying
+     *  close to each other (gap up to BatchMaxGap bytes, e.g. consecutive
+     *  members separated only by header and padding) are fetched by single
+     *  I/O. In mmap mode data are copied from the mapping.
+     *
+     *  Thread safe (doesn't use cursor).
+     */
+    std::vector<Data> readData(const File::list &files) const;
+
+    /** Maximum gap between files read by single I/O in batched readData().
+     */
+    static constexpr std::size_t BatchMaxGap = 1 << 16;
+
+    /** Builds archive index (stops after limit files).
+     *
+     *  Headers are read via large positional reads (IndexReadSize bytes at
+     *  once), i.e. small members cost no syscall at all. Reader cursor is
+     *  left past the last scanned header.
+     *
+     *  \param limit maximum number of returned files
+     *  \param adviseSequential hint kernel (posix_fadvise) that archive is
+     *                          read sequentially during scan; useful for
+     *                          archives with many small members
+     */
     File::list files(std::size_t limit
-                     = std::numeric_limits<std::size_t>::max());
+                     = std::numeric_limits<std::size_t>::max()
+                     , bool adviseSequential = false);
+
+    /** Size of positional read used by files().
+     */
+    static constexpr std::size_t IndexReadSize = 1 << 20;
 
     const boost::filesystem::path& path() const { return path_; }
 
@@ -181,31 +273,115 @@ private:
     utility::Filedes fd_;
 
     std::size_t cursor_;
+
+    /** Archive mapping, mmap mode only.
+     */
+    MappedFile::pointer mapping_;
 };
 
+/** Tar archive writer.
+ *
+ *  Members are written as ustar headers; path or size that doesn't fit ustar
+ *  limits is stored in PAX extended header preceding the member.
+ *
+ *  File data are copied into the archive by the kernel
+ *  (copy_file_range/sendfile, see utility::copyRange), i.e. they never pass
+ *  through user space streams.
+ *
+ *  Archive can be written into any file descriptor, including non-seekable
+ *  ones (pipes, sockets). Member data can be streamed piece by piece via
+ *  begin() and append().
+ */
 class Writer {
 public:
     enum Flags {
         truncate = 0x01
         , create = 0x02
         , exclusive = 0x04
+
+        /** Append to existing archive: new members replace the archive
+         *  terminator. Truncate and exclusive flags are ignored.
+         */
+        , extend = 0x08
     };
 
     Writer(const boost::filesystem::path &path
            , int flags = Flags::create | Flags::exclusive | Flags::truncate);
 
-    void write(const Header &header, std::size_t block, std::size_t size);
+    /** Writes archive into already open file descriptor at its current
+     *  position. Takes ownership of the descriptor.
+     */
+    explicit Writer(utility::Filedes &&fd);
+
+    /** Warns on unterminated archive.
+     */
+    ~Writer();
 
+    /** Writes raw header and given data. Header size must match data size.
+     */
+    void write(const Header &header, const void *data, std::size_t size);
+
+    /** Writes raw header and content of given file. Header size must match
+     *  file size. Data are copied by the kernel.
+     */
     void write(const Header &header, const boost::filesystem::path &file);
 
+    /** Adds file from filesystem as archivePath. Size, modification time
+     *  and mode are taken from the file. Data are copied by the kernel.
+     */
+    void add(const boost::filesystem::path &file
+             , const boost::filesystem::path &archivePath);
+
+    /** Adds file with given content.
+     */
+    void add(const boost::filesystem::path &archivePath
+             , const void *data, std::size_t size, std::time_t mtime = 0);
+
+    /** Begins streamed member of given size. Exactly size bytes must be
+     *  written by append() calls; member is finished by the last one.
+     */
+    void begin(const boost::filesystem::path &archivePath, std::size_t size
+               , std::time_t mtime = 0);
+
+    /** Appends data to member started by begin().
+     */
+    void append(const void *data, std::size_t size);
+
     /** Write file terminator
      */
     void end();
 
+    /** Number of bytes written so far (appended archives: including the
+     *  original content; descriptors: including anything before their
+     *  initial position).
+     */
+    std::uint64_t position() const { return position_; }
+
 private:
+    void writeHeaders(const boost::filesystem::path &archivePath
+                      , std::size_t size, std::time_t mtime
+                      , unsigned int mode);
+
+    void writeRaw(const void *data, std::size_t size);
+
+    /** Pads current member to block boundary.
+     */
+    void pad(std::size_t size);
+
+    void checkIdle() const;
+
     boost::filesystem::path path_;
 
     utility::Filedes fd_;
+
+    std::uint64_t position_;
+
+    /** Streamed member: remaining bytes and total size.
+     */
+    std::size_t remaining_;
+    std::size_t streamed_;
+
+    bool ended_;
 };
 
 // inlines
@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/crc.hpp>
+
+#include "../crc32.hpp"
+
+#include "dbglog/dbglog.hpp"
+
+namespace {
+
+std::uint32_t reference(const unsigned char *data, std::size_t size)
+{
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(utility_crc32)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/crc32 ("
+                       << utility::crc32Implementation() << ").");
+
+    std::vector<unsigned char> data(1 << 16);
+    std::srand(42);
+    for (auto &c : data) { c = std::rand(); }
+
+    BOOST_CHECK_EQUAL(utility::crc32("123456789", 9), 0xcbf43926u);
+    BOOST_CHECK_EQUAL(utility::crc32(nullptr, 0), 0u);
+
+    const bool pclmul(utility::detail::crc32PclmulSupported());
+
+    // various sizes and alignments
+    for (std::size_t offset(0); offset < 16; offset += 3) {
+        for (std::size_t size(0); size < 1200; size += (size < 300) ? 1 : 97)
+        {
+            const auto p(data.data() + offset);
+            const auto expected(reference(p, size));
+
+            BOOST_CHECK_EQUAL(utility::detail::crc32Slicing8(p, size, 0)
+                              , expected);
+            if (pclmul) {
+                BOOST_CHECK_EQUAL(utility::detail::crc32Pclmul(p, size, 0)
+                                  , expected);
+            }
+        }
+    }
+
+    // incremental computation
+    utility::Crc32 crc;
+    for (std::size_t pos(0), step(1); pos < data.size(); step *= 3) {
+        const auto size(std::min(step, data.size() - pos));
+        crc.process_bytes(data.data() + pos, size);
+        pos += size;
+    }
+    BOOST_CHECK_EQUAL(crc.checksum(), reference(data.data(), data.size()));
+}
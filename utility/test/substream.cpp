@@ -0,0 +1,106 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if UTILITY_HAS_BOOST_IOSTREAMS
+
+#include <fcntl.h>
+
+#include <string>
+#include <fstream>
+#include <iterator>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+
+#include "../substream.hpp"
+#include "../filedes.hpp"
+
+#include "dbglog/dbglog.hpp"
+
+namespace fs = boost::filesystem;
+namespace bio = boost::iostreams;
+
+BOOST_AUTO_TEST_CASE(utility_substream_block_cache)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/substream with block cache.");
+
+    const auto path(fs::temp_directory_path()
+                    / fs::unique_path("utility-test-%%%%-%%%%.bin"));
+
+    std::string content(300000, '\0');
+    for (std::size_t i(0); i < content.size(); ++i) {
+        content[i] = char('a' + (i * 7) % 26);
+    }
+    {
+        std::ofstream f(path.string(), std::ios::binary);
+        f << content;
+    }
+
+    utility::Filedes fd(::open(path.string().c_str(), O_RDONLY), path);
+    BOOST_REQUIRE(fd);
+
+    // room for two 64 KiB blocks
+    const auto cache(std::make_shared<utility::io::BlockCache>(2 << 16));
+
+    const auto read([&](std::size_t start, std::size_t end) -> std::string
+    {
+        bio::stream<utility::io::SubStreamDevice> s
+            (utility::io::SubStreamDevice
+             (path, utility::io::SubStreamDevice::Filedes
+              { int(fd), start, end }, cache), 1000);
+        return { std::istreambuf_iterator<char>(s)
+                , std::istreambuf_iterator<char>() };
+    });
+
+    // range spanning block boundary, read twice
+    BOOST_CHECK(read(60000, 70000) == content.substr(60000, 10000));
+    const auto misses(cache->statistics().misses);
+    BOOST_CHECK(read(60000, 70000) == content.substr(60000, 10000));
+    BOOST_CHECK_EQUAL(cache->statistics().misses, misses);
+    BOOST_CHECK_GT(cache->statistics().hits, 0u);
+
+    // whole file, including short last block; budget is respected
+    BOOST_CHECK(read(0, content.size()) == content);
+    BOOST_CHECK_LE(cache->statistics().memory, std::size_t(2 << 16));
+    BOOST_CHECK_GT(cache->statistics().evictions, 0u);
+
+    // rewrite in place, same size: no stale blocks; explicit distinct mtime
+    // keeps the test independent of filesystem timestamp resolution
+    const auto modified(fs::last_write_time(path));
+    for (auto &c : content) { c = char('A' + (c - 'a')); }
+    {
+        std::ofstream f(path.string(), std::ios::binary | std::ios::in);
+        f << content;
+    }
+    fs::last_write_time(path, modified + 10);
+    // last blocks are still cached from the whole file read above
+    BOOST_CHECK(read(250000, 260000) == content.substr(250000, 10000));
+
+    boost::system::error_code ec;
+    fs::remove(path, ec);
+}
+
+#endif // UTILITY_HAS_BOOST_IOSTREAMS
@@ -0,0 +1,363 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fcntl.h>
+
+#include <string>
+#include <fstream>
+#include <cstdlib>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#if UTILITY_HAS_ZLIB
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/copy.hpp>
+#endif
+
+#include "../tar.hpp"
+#include "../tar-index.hpp"
+#if UTILITY_HAS_ZLIB
+#include "../tar-gz.hpp"
+#endif
+
+#include "dbglog/dbglog.hpp"
+
+namespace fs = boost::filesystem;
+namespace tar = utility::tar;
+
+namespace {
+
+struct TemporaryDir {
+    fs::path path;
+
+    TemporaryDir()
+        : path(fs::temp_directory_path()
+               / fs::unique_path("utility-test-%%%%-%%%%"))
+    {
+        fs::create_directories(path);
+    }
+
+    ~TemporaryDir() {
+        boost::system::error_code ec;
+        fs::remove_all(path, ec);
+    }
+};
+
+std::string content(tar::Reader &reader, const tar::Reader::File &file)
+{
+    const auto data(reader.readData(file.start / 512, file.size));
+    return { data.begin(), data.end() };
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(utility_tar_writer)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/tar writer.");
+
+    TemporaryDir tmp;
+    const auto archive(tmp.path / "test.tar");
+
+    const std::string fileContent(1000, 'x');
+    {
+        std::ofstream f((tmp.path / "input").string());
+        f << fileContent;
+    }
+
+    // long path, needs PAX header
+    const std::string longPath(std::string(120, 'd') + "/"
+                               + std::string(120, 'f'));
+
+    {
+        tar::Writer writer(archive);
+        writer.add(tmp.path / "input", "dir/input");
+        writer.add("data", "hello", 5);
+        writer.begin(longPath, 6);
+        writer.append("abc", 3);
+        writer.append("def", 3);
+        writer.end();
+    }
+
+    {
+        tar::Writer writer(archive, tar::Writer::Flags::extend);
+        writer.add("appended", "!", 1);
+        writer.end();
+        BOOST_CHECK_EQUAL(writer.position() % 512, 0u);
+    }
+
+    tar::Reader reader(archive);
+    const auto files(reader.files());
+    BOOST_REQUIRE_EQUAL(files.size(), 4u);
+
+    BOOST_CHECK_EQUAL(files[0].path, fs::path("dir/input"));
+    BOOST_CHECK_EQUAL(content(reader, files[0]), fileContent);
+    BOOST_CHECK_EQUAL(files[1].path, fs::path("data"));
+    BOOST_CHECK_EQUAL(content(reader, files[1]), "hello");
+    BOOST_CHECK_EQUAL(files[2].path, fs::path(longPath));
+    BOOST_CHECK_EQUAL(content(reader, files[2]), "abcdef");
+    BOOST_CHECK_EQUAL(files[3].path, fs::path("appended"));
+    BOOST_CHECK_EQUAL(content(reader, files[3]), "!");
+
+    // truncated last member: refuse to append rather than pad with zeros
+    const auto truncated(tmp.path / "truncated.tar");
+    fs::copy_file(archive, truncated);
+    fs::resize_file(truncated, 512 + 500);
+    BOOST_CHECK_THROW(tar::Writer(truncated, tar::Writer::Flags::extend)
+                      , std::runtime_error);
+    BOOST_CHECK_EQUAL(fs::file_size(truncated), 512u + 500u);
+
+    // descriptor: writing starts at its current position
+    const auto prefixed(tmp.path / "prefixed.tar");
+    {
+        std::ofstream f(prefixed.string());
+        f << std::string(1024, 'p');
+    }
+    utility::Filedes fd(::open(prefixed.string().c_str(), O_WRONLY), prefixed);
+    BOOST_REQUIRE(fd);
+    BOOST_REQUIRE_EQUAL(::lseek(fd, 1024, SEEK_SET), 1024);
+    {
+        tar::Writer writer(std::move(fd));
+        BOOST_CHECK_EQUAL(writer.position(), 1024u);
+        writer.add("data", "hello", 5);
+        writer.end();
+        BOOST_CHECK_EQUAL(writer.position(), fs::file_size(prefixed));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(utility_tar_index)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/tar index.");
+
+    TemporaryDir tmp;
+    const auto archive(tmp.path / "test.tar");
+
+    {
+        tar::Writer writer(archive);
+        writer.add("b", "bbb", 3);
+        writer.add("a", "a", 1);
+        writer.add("c/d", "cd", 2);
+        writer.add("a", "a2", 2);
+        writer.end();
+    }
+
+    tar::Reader reader(archive);
+    const auto index(tar::Index::open(reader));
+    BOOST_REQUIRE(index);
+    BOOST_CHECK(fs::exists(tar::Index::defaultPath(archive)));
+    BOOST_CHECK_EQUAL(index->size(), 4u);
+
+    // duplicate path: last one wins
+    const auto a(index->find("a"));
+    BOOST_REQUIRE(a);
+    BOOST_CHECK_EQUAL(content(reader, *a), "a2");
+    BOOST_CHECK_EQUAL(content(reader, *index->find("c/d")), "cd");
+    BOOST_CHECK(!index->find("c"));
+    BOOST_CHECK(!index->find("z"));
+
+    // same size rewrite with mtime kept at the same second -> index is stale
+    {
+        const auto modified(fs::last_write_time(archive));
+        std::fstream f(archive.string()
+                       , std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(512);
+        f << 'B';
+        f.close();
+        fs::last_write_time(archive, modified);
+    }
+    tar::Reader rewritten(archive);
+    BOOST_CHECK(!tar::Index::load(tar::Index::defaultPath(archive)
+                                  , utility::FileKey::from
+                                  (rewritten.filedes())));
+
+    // archive grows -> index is stale
+    {
+        tar::Writer writer(archive, tar::Writer::Flags::extend);
+        writer.add("e", "eeeee", 5);
+        writer.end();
+    }
+
+    tar::Reader grown(archive);
+    BOOST_CHECK(!tar::Index::load(tar::Index::defaultPath(archive)
+                                  , utility::FileKey::from
+                                  (grown.filedes())));
+    const auto reindexed(tar::Index::open(grown));
+    BOOST_REQUIRE(reindexed);
+    BOOST_CHECK_EQUAL(reindexed->size(), 5u);
+    BOOST_CHECK_EQUAL(content(grown, *reindexed->find("e")), "eeeee");
+
+    // failed save (cannot replace directory) leaves no temporary file behind
+    const auto blocked(tmp.path / "blocked");
+    fs::create_directories(blocked / "x");
+    BOOST_CHECK_THROW(tar::Index::save(blocked, grown.files()
+                                       , utility::FileKey::from
+                                       (grown.filedes()))
+                      , std::runtime_error);
+    BOOST_CHECK_EQUAL(std::distance(fs::directory_iterator(tmp.path)
+                                    , fs::directory_iterator()), 3);
+}
+
+BOOST_AUTO_TEST_CASE(utility_tar_view)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/tar memory mapped views.");
+
+    TemporaryDir tmp;
+    const auto archive(tmp.path / "test.tar");
+
+    const std::string big(100000, 'b');
+    {
+        tar::Writer writer(archive);
+        writer.add("small", "small", 5);
+        writer.add("big", big.data(), big.size());
+        writer.end();
+    }
+
+    tar::Reader reader(archive, true);
+    BOOST_REQUIRE(reader.mapped());
+
+    const auto files(reader.files());
+    BOOST_REQUIRE_EQUAL(files.size(), 2u);
+
+    const auto small(reader.view(files[0]));
+    BOOST_CHECK_EQUAL(std::string(small.begin(), small.end()), "small");
+
+    const auto view(reader.view(files[1]
+                                , utility::MappedFile::Advice::sequential));
+    BOOST_CHECK_EQUAL(std::string(view.begin(), view.end()), big);
+
+    // past the end
+    BOOST_CHECK_THROW(reader.view(files[1].start / 512, big.size() + 10240)
+                      , std::runtime_error);
+
+    // not mapped
+    tar::Reader plain(archive);
+    BOOST_CHECK_THROW(plain.view(files[0]), std::logic_error);
+}
+
+BOOST_AUTO_TEST_CASE(utility_tar_batch)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/tar batched reads.");
+
+    TemporaryDir tmp;
+    const auto archive(tmp.path / "test.tar");
+
+    std::vector<std::string> contents;
+    {
+        tar::Writer writer(archive);
+        for (int i(0); i < 50; ++i) {
+            // every 10th member is bigger than the coalescing gap
+            contents.push_back
+                (std::string((i % 10) ? (i * 37) : (1 << 17), char('a' + i)));
+            writer.add("file" + std::to_string(i), contents.back().data()
+                       , contents.back().size());
+        }
+        writer.end();
+    }
+
+    for (const bool mmap : { false, true }) {
+        tar::Reader reader(archive, mmap);
+        const auto files(reader.files());
+        BOOST_REQUIRE_EQUAL(files.size(), contents.size());
+
+        // reversed order with duplicates
+        std::vector<std::size_t> indices;
+        tar::Reader::File::list batch;
+        for (int i(49); i >= 0; i -= 3) {
+            indices.push_back(i);
+            indices.push_back(i);
+        }
+        for (const auto i : indices) { batch.push_back(files[i]); }
+
+        const auto data(reader.readData(batch));
+        BOOST_REQUIRE_EQUAL(data.size(), batch.size());
+        for (std::size_t i(0); i < data.size(); ++i) {
+            BOOST_CHECK_EQUAL(std::string(data[i].begin(), data[i].end())
+                              , contents[indices[i]]);
+        }
+    }
+}
+
+#if UTILITY_HAS_ZLIB
+
+BOOST_AUTO_TEST_CASE(utility_tar_gzip)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/tar gzip compressed archive.");
+
+    namespace bio = boost::iostreams;
+
+    TemporaryDir tmp;
+    const auto archive(tmp.path / "test.tar");
+    const auto tgz(tmp.path / "test.tar.gz");
+
+    // poorly compressible content to get multiple checkpoints
+    std::srand(42);
+    std::vector<std::string> contents;
+    {
+        tar::Writer writer(archive);
+        for (int i(0); i < 20; ++i) {
+            std::string content((i + 1) * 10000, '\0');
+            for (auto &c : content) { c = 'a' + std::rand() % 16; }
+            contents.push_back(content);
+            writer.add("file" + std::to_string(i), content.data()
+                       , content.size());
+        }
+        writer.end();
+    }
+
+    {
+        std::ifstream in(archive.string(), std::ios::binary);
+        std::ofstream out(tgz.string(), std::ios::binary);
+        bio::filtering_ostream gz;
+        gz.push(bio::gzip_compressor());
+        gz.push(out);
+        bio::copy(in, gz);
+    }
+
+    const auto check([&](const tar::GzipReader &reader)
+    {
+        BOOST_REQUIRE_EQUAL(reader.files().size(), contents.size());
+        // backwards to exercise checkpoints
+        for (std::size_t i(contents.size()); i--; ) {
+            const auto &file(reader.files()[i]);
+            BOOST_CHECK_EQUAL(file.path, fs::path("file" + std::to_string(i)));
+            const auto data(reader.readData(file));
+            BOOST_CHECK(std::string(data.begin(), data.end()) == contents[i]);
+        }
+    });
+
+    {
+        tar::GzipReader reader(tgz, 1 << 16);
+        BOOST_CHECK_GT(reader.index()->checkpoints().size(), 5u);
+        check(reader);
+        reader.saveIndex();
+    }
+
+    // loaded from persisted index
+    BOOST_REQUIRE(fs::exists(tmp.path / "test.tar.gz.gzidx"));
+    check(tar::GzipReader(tgz));
+}
+
+#endif // UTILITY_HAS_ZLIB
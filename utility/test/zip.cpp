@@ -0,0 +1,827 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#if UTILITY_HAS_BOOST_IOSTREAMS
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <iterator>
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include "../zip.hpp"
+#include "../zip-cache.hpp"
+#if __cplusplus >= 201402L
+#include "../zip-async.hpp"
+#endif
+#include "../memoryfile.hpp"
+
+#include "dbglog/dbglog.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace {
+
+struct TemporaryZip {
+    fs::path path;
+
+    TemporaryZip()
+        : path(fs::temp_directory_path()
+               / fs::unique_path("utility-test-%%%%-%%%%.zip"))
+    {}
+
+    ~TemporaryZip() {
+        boost::system::error_code ec;
+        fs::remove(path, ec);
+    }
+};
+
+void writeZip(const fs::path &path, const std::vector<std::string> &files
+              , utility::zip::Compression compression
+              = utility::zip::Compression::deflate)
+{
+    utility::zip::Writer zip(path, true);
+    for (const auto &file : files) {
+        auto os(zip.ostream(file, compression));
+        os->get() << "content of " << file;
+        os->close();
+    }
+    zip.close();
+}
+
+std::vector<std::string> paths(const utility::zip::Reader &zip
+                               , const std::vector<std::size_t> &indices)
+{
+    std::vector<std::string> out;
+    for (const auto index : indices) {
+        out.push_back(zip.files()[index].path().string());
+    }
+    return out;
+}
+
+std::string content(const utility::zip::Reader &zip, std::size_t index)
+{
+    boost::iostreams::filtering_istream fis;
+    zip.plug(index, fis);
+    std::ostringstream os;
+    os << fis.rdbuf();
+    return os.str();
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(utility_zip_find)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip path index.");
+
+    TemporaryZip tmp;
+    writeZip(tmp.path, { "b/x.txt", "a/1.txt", "a/c/2.txt", "a/3.txt"
+                         , "ab.txt" });
+
+    utility::zip::Reader zip(tmp.path);
+    BOOST_REQUIRE_EQUAL(zip.files().size(), 5);
+
+    for (const auto &record : zip.files()) {
+        BOOST_CHECK_EQUAL(zip.find(record.path()), record.index);
+    }
+
+    BOOST_CHECK(zip.has("/a/c/2.txt"));
+    BOOST_CHECK(!zip.has("/a/c"));
+    BOOST_CHECK(!zip.find("/nonexistent", std::nothrow));
+    BOOST_CHECK_THROW(zip.find("/nonexistent"), utility::zip::Error);
+
+    const std::vector<std::string> recursive
+        { "/a/1.txt", "/a/3.txt", "/a/c/2.txt" };
+    const auto lr(paths(zip, zip.list("/a")));
+    BOOST_CHECK_EQUAL_COLLECTIONS(lr.begin(), lr.end()
+                                  , recursive.begin(), recursive.end());
+
+    const std::vector<std::string> direct { "/a/1.txt", "/a/3.txt" };
+    const auto ld(paths(zip, zip.list("/a/", false)));
+    BOOST_CHECK_EQUAL_COLLECTIONS(ld.begin(), ld.end()
+                                  , direct.begin(), direct.end());
+
+    BOOST_CHECK_EQUAL(zip.list("/").size(), 5);
+    BOOST_CHECK_EQUAL(zip.list("/", false).size(), 1);
+    BOOST_CHECK(zip.list("/nonexistent").empty());
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_mmap)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip memory mapped reader.");
+
+    TemporaryZip stored;
+    writeZip(stored.path, { "a.txt", "b.txt" }
+             , utility::zip::Compression::store);
+
+    TemporaryZip deflated;
+    writeZip(deflated.path, { "a.txt" });
+
+    utility::zip::ReaderOptions options;
+    options.mmap = true;
+
+    utility::zip::Reader::View view;
+    {
+        utility::zip::Reader zip(stored.path, options);
+        BOOST_REQUIRE(zip.mapped());
+        view = zip.view(zip.find("/b.txt"));
+        BOOST_CHECK_EQUAL(content(zip, zip.find("/a.txt"))
+                          , "content of a.txt");
+    }
+
+    // view outlives the reader
+    BOOST_CHECK_EQUAL(std::string(view.begin(), view.end())
+                      , "content of b.txt");
+
+    utility::zip::Reader zip(deflated.path, options);
+    BOOST_CHECK_EQUAL(content(zip, 0), "content of a.txt");
+    BOOST_CHECK_THROW(zip.view(0), utility::zip::Error);
+
+    utility::zip::Reader unmapped(stored.path);
+    BOOST_CHECK_THROW(unmapped.view(0), utility::zip::Error);
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_memory)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip reader over memory and fd.");
+
+    TemporaryZip tmp;
+    writeZip(tmp.path, { "a.txt", "b.txt" }
+             , utility::zip::Compression::store);
+
+    auto data(std::make_shared<std::string>());
+    {
+        std::ifstream f(tmp.path.string(), std::ios_base::binary);
+        std::ostringstream os;
+        os << f.rdbuf();
+        *data = os.str();
+    }
+
+    utility::zip::Reader::View view;
+    {
+        utility::zip::Reader zip
+            (utility::MemoryView(data->data(), data->size(), data));
+        BOOST_REQUIRE(zip.mapped());
+        BOOST_CHECK_EQUAL(content(zip, zip.find("/a.txt"))
+                          , "content of a.txt");
+        view = zip.view(zip.find("/b.txt"));
+    }
+
+    // view keeps the memory alive
+    data.reset();
+    BOOST_CHECK_EQUAL(std::string(view.begin(), view.end())
+                      , "content of b.txt");
+
+    // archive in anonymous memory file
+    auto fd(utility::memoryFile("utility-test-zip"
+                                , utility::MemoryFileFlag::closeOnExec));
+    {
+        std::ifstream f(tmp.path.string(), std::ios_base::binary);
+        std::ofstream os(fd.path().string(), std::ios_base::binary);
+        os << f.rdbuf();
+    }
+
+    utility::zip::Reader zip(std::move(fd));
+    BOOST_CHECK(!zip.mapped());
+    BOOST_CHECK_EQUAL(content(zip, zip.find("/b.txt")), "content of b.txt");
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_extract)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip parallel extraction.");
+
+    std::vector<std::string> files;
+    for (int i(0); i < 100; ++i) {
+        files.push_back("dir" + std::to_string(i % 7) + "/file"
+                        + std::to_string(i) + ".txt");
+    }
+
+    TemporaryZip tmp;
+    writeZip(tmp.path, files);
+
+    utility::zip::Reader zip(tmp.path);
+
+    std::mutex mutex;
+    std::map<std::string, std::string> extracted;
+    zip.extract([&](const utility::zip::Reader::Record &record
+                    , std::istream &is)
+    {
+        std::ostringstream os;
+        os << is.rdbuf();
+        std::unique_lock<std::mutex> lock(mutex);
+        extracted[record.path().string()] = os.str();
+    }, 4);
+
+    BOOST_REQUIRE_EQUAL(extracted.size(), files.size());
+    for (const auto &file : files) {
+        BOOST_CHECK_EQUAL(extracted["/" + file], "content of " + file);
+    }
+
+    const auto destination(fs::temp_directory_path()
+                           / fs::unique_path("utility-test-%%%%-%%%%"));
+    zip.extract(zip.list("/dir3"), destination, 3);
+
+    std::size_t count(0);
+    for (fs::recursive_directory_iterator i(destination), e; i != e; ++i) {
+        if (fs::is_directory(i->path())) { continue; }
+        ++count;
+        std::ifstream f(i->path().string());
+        std::string line;
+        std::getline(f, line);
+        BOOST_CHECK_EQUAL(line, "content of " + fs::relative
+                          (i->path(), destination).generic_string());
+    }
+    BOOST_CHECK_EQUAL(count, zip.list("/dir3").size());
+    fs::remove_all(destination);
+
+    // duplicate paths: first one wins (as in find()), no interleaved output;
+    // writer replaces same archive path, i.e. 18th and 19th file remain
+    TemporaryZip dup;
+    std::vector<std::string> contents;
+    {
+        utility::zip::Writer writer(dup.path, true);
+        for (int i(0); i < 20; ++i) {
+            contents.push_back(std::string(100000 - i * 1000, char('a' + i)));
+            auto os(writer.ostream(i % 2 ? "./dup.txt" : "dup.txt"));
+            os->get() << contents.back();
+            os->close();
+        }
+        writer.close();
+    }
+
+    utility::zip::Reader dupZip(dup.path);
+    BOOST_REQUIRE_EQUAL(dupZip.files().size(), 2);
+    BOOST_CHECK_EQUAL(dupZip.find("/dup.txt"), 0);
+    dupZip.extract(destination, 8);
+    std::ifstream f((destination / "dup.txt").string());
+    BOOST_CHECK(std::string(std::istreambuf_iterator<char>(f)
+                            , std::istreambuf_iterator<char>())
+                == contents[18]);
+    fs::remove_all(destination);
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_concurrent)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip concurrent writer.");
+
+    // content of i-th file, some of them larger than spill threshold
+    const auto data([](int i) -> std::string
+    {
+        std::string out;
+        for (int j(0); j < (i % 5) * 100; ++j) {
+            out += std::to_string(i * j) + ",";
+        }
+        return out;
+    });
+
+    const int count(64);
+
+    TemporaryZip tmp;
+    {
+        utility::zip::Writer zip(tmp.path, true);
+        zip.concurrent(1000);
+
+        std::atomic<int> next(0);
+        std::vector<std::thread> threads;
+        for (int t(0); t < 4; ++t) {
+            threads.emplace_back([&]()
+            {
+                for (int i; (i = next++) < count; ) {
+                    auto os(zip.ostream("file" + std::to_string(i)
+                                        , (i % 2)
+                                        ? utility::zip::Compression::deflate
+                                        : utility::zip::Compression::store));
+                    os->get() << data(i);
+                    os->close();
+                }
+            });
+        }
+        for (auto &thread : threads) { thread.join(); }
+
+        zip.close();
+    }
+
+    utility::zip::Reader zip(tmp.path);
+    BOOST_REQUIRE_EQUAL(zip.files().size(), count);
+    for (int i(0); i < count; ++i) {
+        BOOST_CHECK_EQUAL(content(zip, zip.find("/file" + std::to_string(i)))
+                          , data(i));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_verify)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip parallel verification.");
+
+    TemporaryZip tmp;
+    writeZip(tmp.path, { "a.txt", "b.txt", "c.txt" }
+             , utility::zip::Compression::store);
+
+    {
+        utility::zip::Reader zip(tmp.path);
+        const auto report(zip.verify(2));
+        BOOST_CHECK(report.ok());
+        BOOST_CHECK_EQUAL(report.results.size(), 3);
+        BOOST_CHECK_EQUAL(report.uncompressedBytes, 3 * 16);
+    }
+
+    // corrupt content of b.txt
+    {
+        std::fstream f(tmp.path.string(), std::ios_base::in
+                       | std::ios_base::out | std::ios_base::binary);
+        std::ostringstream os;
+        os << f.rdbuf();
+        const auto offset(os.str().find("content of b.txt"));
+        BOOST_REQUIRE(offset != std::string::npos);
+        f.seekp(offset);
+        f.put('C');
+    }
+
+    utility::zip::Reader zip(tmp.path);
+    const auto report(zip.verify({ zip.find("/b.txt"), zip.find("/c.txt") }));
+    BOOST_CHECK_EQUAL(report.failed, 1);
+    BOOST_CHECK(!report.results[0].ok);
+    BOOST_CHECK(!report.results[0].error.empty());
+    BOOST_CHECK(report.results[1].ok);
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_record_count)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip bogus record count.");
+
+    TemporaryZip tmp;
+    writeZip(tmp.path, { "a.txt" });
+
+    // claim 2^40 records in ZIP64 end of central directory record
+    {
+        std::fstream f(tmp.path.string(), std::ios_base::in
+                       | std::ios_base::out | std::ios_base::binary);
+        std::ostringstream os;
+        os << f.rdbuf();
+        const auto offset(os.str().rfind(std::string("PK\x06\x06", 4)));
+        BOOST_REQUIRE(offset != std::string::npos);
+        const std::string count("\0\0\0\0\0\x01\0\0", 8);
+        f.seekp(offset + 24);
+        f.write(count.data(), count.size());
+        f.write(count.data(), count.size());
+    }
+
+    // record list is not sized by the count, the central directory simply
+    // runs out of records
+    BOOST_CHECK_THROW(utility::zip::Reader(tmp.path)
+                      , utility::zip::Error);
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_cache)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip reader cache.");
+
+    TemporaryZip a, b;
+    writeZip(a.path, { "a.txt" });
+    writeZip(b.path, { "b.txt" });
+
+    utility::zip::ReaderCache::Options options;
+    options.fdBudget = 1;
+    utility::zip::ReaderCache cache(options);
+
+    const auto ra(cache.get(a.path));
+    BOOST_CHECK_EQUAL(cache.get(a.path), ra);
+    BOOST_CHECK_EQUAL(cache.statistics().hits, 1);
+
+    // archive change is detected
+    writeZip(a.path, { "a.txt", "c.txt" });
+    const auto ra2(cache.get(a.path));
+    BOOST_CHECK(ra2 != ra);
+    BOOST_CHECK_EQUAL(ra2->files().size(), 2);
+    BOOST_CHECK_EQUAL(cache.statistics().invalidations, 1);
+
+    // same size rewrite within the same second is detected as well
+    {
+        const auto modified(fs::last_write_time(a.path));
+        writeZip(a.path, { "a.txt", "d.txt" });
+        fs::last_write_time(a.path, modified);
+    }
+    const auto ra3(cache.get(a.path));
+    BOOST_CHECK(ra3 != ra2);
+    BOOST_CHECK_EQUAL(ra3->find("/d.txt"), 1);
+    BOOST_CHECK_EQUAL(cache.statistics().invalidations, 2);
+
+    // fd budget allows single reader only
+    cache.get(b.path);
+    const auto stats(cache.statistics());
+    BOOST_CHECK_EQUAL(stats.evictions, 1);
+    BOOST_CHECK_EQUAL(stats.size, 1);
+    BOOST_CHECK_EQUAL(stats.fds, 1);
+
+    // evicted reader is still usable
+    BOOST_CHECK_EQUAL(content(*ra3, ra3->find("/d.txt")), "content of d.txt");
+}
+
+#if __cplusplus >= 201402L
+BOOST_AUTO_TEST_CASE(utility_zip_async)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip asynchronous reads.");
+
+    TemporaryZip tmp;
+    writeZip(tmp.path, { "a.txt", "b.txt" });
+
+    const auto zip(std::make_shared<const utility::zip::Reader>(tmp.path));
+
+    boost::asio::io_context ioc;
+    auto work(boost::asio::make_work_guard(ioc));
+
+    std::map<std::size_t, std::string> contents;
+    std::size_t failed(0);
+    std::size_t done(0);
+
+    auto callback([&](std::size_t index)
+    {
+        return [&, index](utility::zip::AsyncReader::Result &&result)
+        {
+            try {
+                const auto &buffer(*result.get());
+                contents[index].assign(buffer.begin(), buffer.end());
+            } catch (const utility::zip::Error&) {
+                ++failed;
+            }
+            if (++done == 3) { work.reset(); }
+        };
+    });
+
+    utility::zip::AsyncReader reader(2);
+    reader.asyncRead(zip, zip->find("/a.txt"), ioc, callback(0));
+    reader.asyncRead(zip, zip->find("/b.txt"), ioc, callback(1));
+    reader.asyncRead(zip, 100, ioc, callback(2));
+    ioc.run();
+
+    BOOST_CHECK_EQUAL(contents[0], "content of a.txt");
+    BOOST_CHECK_EQUAL(contents[1], "content of b.txt");
+    BOOST_CHECK_EQUAL(failed, 1);
+}
+#endif // __cplusplus >= 201402L
+
+BOOST_AUTO_TEST_CASE(utility_zip_automatic)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip automatic compression.");
+
+    std::string text;
+    while (text.size() < 100000) { text += "compressible line of text\n"; }
+
+    std::string noise(100000, '\0');
+    std::uint32_t state(1);
+    for (auto &c : noise) {
+        state = state * 1664525 + 1013904223;
+        c = char(state >> 24);
+    }
+
+    TemporaryZip tmp;
+    utility::zip::Writer writer(tmp.path, true);
+    auto write([&](const std::string &path, const std::string &data)
+    {
+        auto os(writer.ostream(path, utility::zip::Compression::automatic));
+        os->get().write(data.data(), data.size());
+        return os->close();
+    });
+
+    const auto textStats(write("text.txt", text));
+    BOOST_CHECK(textStats.compression == utility::zip::Compression::deflate);
+    BOOST_CHECK_EQUAL(textStats.sampleSize
+                      , utility::zip::Writer::AutoSampleSize);
+    BOOST_CHECK(textStats.compressedSize < text.size());
+
+    const auto noiseStats(write("noise.bin", noise));
+    BOOST_CHECK(noiseStats.compression == utility::zip::Compression::store);
+    BOOST_CHECK_EQUAL(noiseStats.compressedSize, noise.size());
+
+    const auto emptyStats(write("empty", {}));
+    BOOST_CHECK(emptyStats.compression == utility::zip::Compression::store);
+
+    writer.close();
+
+    utility::zip::Reader zip(tmp.path);
+    BOOST_CHECK_EQUAL(content(zip, zip.find("/text.txt")), text);
+    BOOST_CHECK(content(zip, zip.find("/noise.bin")) == noise);
+    BOOST_CHECK(zip.verify().ok());
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_read)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip whole file reads.");
+
+    std::string large;
+    while (large.size() < (3 << 20)) {
+        large += boost::lexical_cast<std::string>(large.size());
+    }
+
+    TemporaryZip tmp;
+    {
+        utility::zip::Writer writer(tmp.path, true);
+        for (const auto compression : { utility::zip::Compression::store
+                    , utility::zip::Compression::deflate })
+        {
+            const auto name(boost::lexical_cast<std::string>(compression));
+            auto os(writer.ostream(name + ".txt", compression));
+            os->get() << "content of " << name;
+            os->close();
+
+            os = writer.ostream(name + ".large", compression);
+            os->get() << large;
+            os->close();
+        }
+        writer.close();
+    }
+
+    utility::zip::Reader zip(tmp.path);
+    for (const auto &record : zip.files()) {
+        const auto data(zip.read(record.index));
+        const auto path(record.path());
+        const auto expected((path.extension() == ".large")
+                            ? large
+                            : "content of " + path.stem().string());
+        BOOST_CHECK(std::string(data.begin(), data.end()) == expected);
+        BOOST_CHECK(content(zip, record.index) == expected);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_stream)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip streaming writer.");
+
+    std::ostringstream out;
+    {
+        utility::zip::StreamWriter writer(out);
+        for (const auto compression : { utility::zip::Compression::store
+                    , utility::zip::Compression::deflate
+                    , utility::zip::Compression::automatic })
+        {
+            const auto name(boost::lexical_cast<std::string>(compression));
+            auto os(writer.ostream(name + ".txt", compression));
+            os->get() << "content of " << name;
+            os->close();
+        }
+
+        // stored file over the buffer limit is streamed
+        auto os(writer.ostream("big.txt"));
+        os->get() << std::string
+            (utility::zip::StreamWriter::StoreBufferSize + 1, 'x');
+        os->close();
+
+        writer.close();
+        BOOST_CHECK_EQUAL(writer.size(), out.str().size());
+    }
+
+    const auto data(std::make_shared<std::string>(out.str()));
+    utility::zip::Reader zip
+        (utility::MemoryView(data->data(), data->size(), data));
+    BOOST_REQUIRE_EQUAL(zip.files().size(), 4);
+    for (const auto &record : zip.files()) {
+        const auto name(record.path().stem().string());
+        // small stored files (incl. automatic one: sample is too short to
+        // compress) are written without data descriptor
+        BOOST_CHECK_EQUAL(bool(record.header.flag & (1 << 3))
+                          , ((name == "deflate") || (name == "big")));
+        if (name == "big") {
+            BOOST_CHECK_EQUAL
+                (content(zip, record.index)
+                 , std::string(utility::zip::StreamWriter::StoreBufferSize
+                               + 1, 'x'));
+            continue;
+        }
+        BOOST_CHECK_EQUAL(content(zip, record.index), "content of " + name);
+    }
+    BOOST_CHECK(zip.verify().ok());
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_addFile)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip addFile.");
+
+    std::string data;
+    for (int i(0); data.size() < (1 << 20); ++i) {
+        data += std::to_string(i * 2654435761u);
+    }
+
+    const auto source(fs::temp_directory_path()
+                      / fs::unique_path("utility-test-%%%%-%%%%.bin"));
+    const auto empty(fs::path(source.string() + ".empty"));
+    std::ofstream(source.string(), std::ios_base::binary) << data;
+    std::ofstream(empty.string(), std::ios_base::binary);
+
+    TemporaryZip tmp;
+    {
+        utility::zip::Writer zip(tmp.path, true);
+        zip.addFile(source, "stored");
+        zip.addFile(empty, "empty");
+        zip.addFile(source, "deflated", utility::zip::Compression::deflate);
+        zip.close();
+    }
+    fs::remove(source);
+    fs::remove(empty);
+
+    utility::zip::Reader zip(tmp.path);
+    BOOST_REQUIRE_EQUAL(zip.files().size(), 3);
+    BOOST_CHECK_EQUAL(content(zip, zip.find("/stored")), data);
+    BOOST_CHECK_EQUAL(content(zip, zip.find("/empty")), "");
+    BOOST_CHECK_EQUAL(content(zip, zip.find("/deflated")), data);
+}
+
+BOOST_AUTO_TEST_CASE(utility_zip_copy)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip raw copy between archives.");
+
+    const std::string data(std::string(5000, 'a') + "tail");
+
+    TemporaryZip src;
+    {
+        utility::zip::Writer zip(src.path, true);
+        for (const auto compression : { utility::zip::Compression::store
+                                        , utility::zip::Compression::deflate
+                                        , utility::zip::Compression::bzip2 })
+        {
+            auto os(zip.ostream(boost::lexical_cast<std::string>(compression)
+                                , compression));
+            os->get() << data;
+            os->close();
+        }
+        zip.close();
+    }
+
+    // give the first local header foreign version and timestamp
+    // (little endian: version needed, flag, method, time, date)
+    const std::string foreign("\x14\x00\x00\x00\x00\x00\x39\x30\x43\x2a"
+                              , 10);
+    {
+        std::fstream f(src.path.string()
+                       , std::ios::in | std::ios::out | std::ios::binary);
+        f.seekp(4);
+        f.write(foreign.data(), 4);
+        f.seekp(10);
+        f.write(foreign.data() + 6, 4);
+    }
+
+    for (const bool mmap : { false, true }) {
+        utility::zip::ReaderOptions options;
+        options.mmap = mmap;
+        utility::zip::Reader source(src.path, options);
+
+        TemporaryZip dst;
+        {
+            utility::zip::Writer zip(dst.path, true);
+            zip.copy(source, 0);
+            zip.copy(source, 1, "renamed");
+            zip.copy(source, 2);
+            zip.close();
+        }
+
+        // copied entry keeps source's version needed and timestamp
+        {
+            std::ifstream f(dst.path.string(), std::ios::binary);
+            char header[14];
+            f.read(header, sizeof(header));
+            BOOST_CHECK_EQUAL(std::string(header + 4, 2), foreign.substr(0, 2));
+            BOOST_CHECK_EQUAL(std::string(header + 10, 4)
+                              , foreign.substr(6, 4));
+        }
+
+        utility::zip::Reader zip(dst.path);
+        BOOST_REQUIRE_EQUAL(zip.files().size(), 3);
+        BOOST_CHECK(zip.has("/store"));
+        BOOST_CHECK(zip.has("/renamed"));
+        BOOST_CHECK(zip.has("/bzip2"));
+
+        for (std::size_t i(0); i < 3; ++i) {
+            const auto from(source.files()[i].header);
+            const auto to(zip.files()[i].header);
+            BOOST_CHECK_EQUAL(to.compressionMethod, from.compressionMethod);
+            BOOST_CHECK_EQUAL(to.compressedSize, from.compressedSize);
+            BOOST_CHECK_EQUAL(to.crc32, from.crc32);
+            BOOST_CHECK_EQUAL(content(zip, i), data);
+        }
+    }
+}
+
+#if UTILITY_HAS_ZLIB
+BOOST_AUTO_TEST_CASE(utility_zip_seek)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip seek index.");
+
+    std::string data;
+    for (int i(0); data.size() < (3 << 20); ++i) {
+        data += "line " + std::to_string(i) + ": "
+            + std::to_string(i * 7919 % 104729) + "\n";
+    }
+
+    TemporaryZip tmp;
+    {
+        utility::zip::Writer zip(tmp.path, true);
+        auto os(zip.ostream("big", utility::zip::Compression::deflate));
+        os->get() << data;
+        os->close();
+        zip.close();
+    }
+
+    const auto check([&](const utility::zip::Reader &zip)
+    {
+        boost::iostreams::filtering_istream fis;
+        BOOST_REQUIRE(zip.plug(0, fis).seekable);
+
+        for (const std::size_t offset
+                 : { std::size_t(2 << 20), std::size_t(17)
+                     , std::size_t(1 << 20) + 333, data.size() - 100 })
+        {
+            std::string buffer(100, '\0');
+            fis.seekg(offset);
+            fis.read(&buffer[0], buffer.size());
+            BOOST_CHECK_EQUAL(buffer, data.substr(offset, buffer.size()));
+        }
+    });
+
+    {
+        utility::zip::Reader zip(tmp.path);
+        {
+            boost::iostreams::filtering_istream fis;
+            BOOST_CHECK(!zip.plug(0, fis).seekable);
+        }
+
+        const auto si(zip.seekIndex(0, 256 << 10));
+        BOOST_CHECK_EQUAL(si->size(), data.size());
+        BOOST_CHECK_GT(si->checkpoints().size(), 4);
+        BOOST_CHECK_EQUAL(zip.seekIndex(0, std::nothrow), si);
+
+        check(zip);
+        zip.saveSeekIndex();
+    }
+
+    utility::zip::Reader zip(tmp.path, [] {
+            utility::zip::ReaderOptions options;
+            options.mmap = true;
+            return options;
+        }());
+    BOOST_REQUIRE(zip.loadSeekIndex());
+    check(zip);
+    fs::remove(zip.seekIndexPath());
+}
+#endif // UTILITY_HAS_ZLIB
+
+#if UTILITY_HAS_ZSTD
+BOOST_AUTO_TEST_CASE(utility_zip_zstd)
+{
+    BOOST_TEST_MESSAGE("* Testing utility/zip zstd compression.");
+
+    const std::string data(std::string(100000, 'x') + "zstd");
+
+    TemporaryZip tmp;
+    {
+        utility::zip::Writer zip(tmp.path, true);
+        for (const int level : { utility::zip::Writer::DefaultLevel, 1, 19 }) {
+            auto os(zip.ostream("level" + std::to_string(level)
+                                , utility::zip::Compression::zstd, {}, level));
+            os->get() << data;
+            const auto stats(os->close());
+            BOOST_CHECK_EQUAL(stats.uncompressedSize, data.size());
+            BOOST_CHECK_LT(stats.compressedSize, data.size() / 100);
+        }
+        zip.close();
+    }
+
+    utility::zip::Reader zip(tmp.path);
+    BOOST_REQUIRE_EQUAL(zip.files().size(), 3);
+    for (const auto &record : zip.files()) {
+        BOOST_CHECK_EQUAL(record.header.compressionMethod, 93);
+        BOOST_CHECK_EQUAL(content(zip, record.index), data);
+    }
+}
+#endif // UTILITY_HAS_ZSTD
+
+#endif // UTILITY_HAS_BOOST_IOSTREAMS
@@ -0,0 +1,239 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <limits>
+#include <vector>
+#include <functional>
+
+#include <boost/filesystem.hpp>
+
+#include "utility/buildsys.hpp"
+#include "utility/gccversion.hpp"
+#include "utility/format.hpp"
+#include "utility/zip.hpp"
+#include "utility/tar.hpp"
+
+#include "service/cmdline.hpp"
+
+namespace po = boost::program_options;
+namespace fs = boost::filesystem;
+
+namespace {
+
+class ArchiveBench : public service::Cmdline
+{
+public:
+    ArchiveBench()
+        : service::Cmdline("utility-archive-bench", BUILD_TARGET_VERSION)
+        , size_(100), repeat_(5), mmap_(false), sequential_(false)
+        , keep_(false)
+    {}
+
+private:
+    virtual void configuration(po::options_description &cmdline
+                               , po::options_description &config
+                               , po::positional_options_description &pd)
+        UTILITY_OVERRIDE;
+
+    virtual void configure(const po::variables_map &vars)
+        UTILITY_OVERRIDE;
+
+    virtual bool help(std::ostream &out, const std::string &what) const
+        UTILITY_OVERRIDE;
+
+    virtual int run() UTILITY_OVERRIDE;
+
+    /** Generates archive with given number of entries.
+     */
+    void generate(const fs::path &path, std::size_t count) const;
+
+    /** Opens/indexes archive, returns number of entries found.
+     */
+    std::size_t open(const fs::path &path) const;
+
+    std::string format_;
+    std::vector<std::size_t> counts_;
+    fs::path workdir_;
+    std::size_t size_;
+    int repeat_;
+    bool mmap_;
+    bool sequential_;
+    bool keep_;
+};
+
+void ArchiveBench::configuration(po::options_description &cmdline
+                                 , po::options_description &config
+                                 , po::positional_options_description &pd)
+{
+    cmdline.add_options()
+        ("format", po::value(&format_)->required()
+         , "Archive format: zip or tar.")
+        ("count", po::value(&counts_)->required()
+         , "Number of entries in generated archive, can be used multiple "
+         "times.")
+        ("size", po::value(&size_)->default_value(size_)->required()
+         , "Size of every entry in bytes.")
+        ("workdir", po::value(&workdir_)
+         ->default_value(fs::temp_directory_path())
+         , "Directory where test archives are generated.")
+        ("repeat", po::value(&repeat_)->default_value(repeat_)->required()
+         , "Number of times each archive is opened.")
+        ("mmap", "zip: Open archives in memory mapped mode.")
+        ("sequential", "tar: Advise kernel about sequential access during "
+         "indexing.")
+        ("keep", "Keep generated archives.")
+        ;
+
+    pd.add("format", 1).add("count", -1);
+
+    (void) config;
+}
+
+void ArchiveBench::configure(const po::variables_map &vars)
+{
+    if ((format_ != "zip") && (format_ != "tar")) {
+        throw po::validation_error
+            (po::validation_error::invalid_option_value, "format");
+    }
+
+    mmap_ = vars.count("mmap");
+    sequential_ = vars.count("sequential");
+    keep_ = vars.count("keep");
+}
+
+bool ArchiveBench::help(std::ostream &out, const std::string &what) const
+{
+    if (what.empty()) {
+        out << R"RAW(utility-archive-bench
+usage
+    utility-archive-bench FORMAT COUNT+ [OPTIONS]
+
+Generates archives in given format (zip or tar) with given number of entries
+and measures time needed to open them via utility::zip::Reader or to index
+them via utility::tar::Reader::files().
+
+)RAW";
+    }
+    return false;
+}
+
+void ArchiveBench::generate(const fs::path &path, std::size_t count) const
+{
+    const std::vector<char> data(size_, 'x');
+    const auto name([](std::size_t i) {
+        return utility::format("dir%d/file%d.bin", i % 1000, i);
+    });
+
+    if (format_ == "tar") {
+        utility::tar::Writer tar(path);
+        for (std::size_t i(0); i < count; ++i) {
+            tar.add(name(i), data.data(), data.size());
+        }
+        tar.end();
+        return;
+    }
+
+    utility::zip::Writer zip(path, true);
+    // no need to reserve space for local header
+    zip.concurrent();
+    for (std::size_t i(0); i < count; ++i) {
+        auto os(zip.ostream(name(i)));
+        os->get().write(data.data(), data.size());
+        os->close();
+    }
+    zip.close();
+}
+
+std::size_t ArchiveBench::open(const fs::path &path) const
+{
+    if (format_ == "tar") {
+        utility::tar::Reader tar(path);
+        return tar.files(std::numeric_limits<std::size_t>::max()
+                         , sequential_).size();
+    }
+
+    utility::zip::ReaderOptions options;
+    options.mmap = mmap_;
+    utility::zip::Reader zip(path, options);
+    return zip.files().size();
+}
+
+int ArchiveBench::run()
+{
+    typedef std::chrono::steady_clock clock;
+    typedef std::chrono::duration<double> seconds;
+
+    std::cout << std::setw(10) << "entries"
+              << std::setw(12) << "best [s]"
+              << std::setw(12) << "mean [s]"
+              << std::setw(16) << "entries/s" << std::endl;
+
+    for (const auto count : counts_) {
+        const auto path(workdir_ / utility::format
+                        ("utility-archive-bench-%d-%d.%s"
+                         , count, size_, format_));
+        if (!fs::exists(path)) { generate(path, count); }
+
+        double best(std::numeric_limits<double>::max());
+        double total(0);
+        for (int r(0); r < repeat_; ++r) {
+            const auto start(clock::now());
+            const auto found(open(path));
+            const seconds duration(clock::now() - start);
+
+            if (found != count) {
+                std::cerr << "Archive " << path << " has "
+                          << found << " entries instead of "
+                          << count << "." << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            best = std::min(best, duration.count());
+            total += duration.count();
+        }
+
+        std::cout << std::setw(10) << count
+                  << std::setw(12) << std::fixed << std::setprecision(6)
+                  << best
+                  << std::setw(12) << (total / repeat_)
+                  << std::setw(16) << std::setprecision(0)
+                  << (count / best) << std::endl;
+
+        if (!keep_) { fs::remove(path); }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    return ArchiveBench()(argc, argv);
+}
@@ -61,6 +61,8 @@ private:
     virtual int run() UTILITY_OVERRIDE;
 
     fs::path zip_;
+    bool verify_ = false;
+    std::size_t jobs_ = 0;
 };
 
 void Zip::configuration(po::options_description &cmdline
@@ -70,6 +72,10 @@ void Zip::configuration(po::options_description &cmdline
     cmdline.add_options()
         ("zip,f", po::value(&zip_)->required()
          , "Zip file.")
+        ("verify", po::bool_switch(&verify_)
+         , "Verify integrity of all files instead of listing them.")
+        ("jobs,j", po::value(&jobs_)->default_value(jobs_)
+         , "Number of verification threads, 0 means number of CPUs.")
         ;
 
     pd.add("zip", 1);
@@ -88,6 +94,7 @@ bool Zip::help(std::ostream &out, const std::string &what) const
         out << R"RAW(utility-lszip
 usage
     utility-lszip ZIP-FILE [OPTIONS]
+    utility-lszip ZIP-FILE --verify [--jobs N]
 
 )RAW";
     }
@@ -99,9 +106,28 @@ int Zip::run()
     utility::zip::Reader zip(zip_, std::numeric_limits<std::size_t>::max()
                              , false);
 
+    if (verify_) {
+        const auto report(zip.verify(jobs_));
+        for (const auto &result : report.results) {
+            const auto &file(zip.files()[result.index]);
+            std::cout
+                << file.path().string() << " "
+                << (result.ok ? std::string("OK") : result.error) << '\n';
+        }
+
+        std::cout
+            << "verified " << report.results.size() << " files, "
+            << report.failed << " failed, "
+            << report.uncompressedBytes << " bytes in "
+            << report.seconds << " s ("
+            << (report.throughput() / (1 << 20)) << " MiB/s)" << std::endl;
+
+        return report.ok() ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
     for (const auto &file : zip.files()) {
         std::cout
-            << file.path.string()
+            << file.path().string()
             << " " << file.header.compressionMethod
             << " " << file.header.compressedSize
             << " " << file.header.uncompressedSize << '\n';
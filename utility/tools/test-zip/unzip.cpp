@@ -62,8 +62,12 @@ private:
 
     virtual int run() UTILITY_OVERRIDE;
 
+    int extract(const utility::zip::Reader &zip);
+
     fs::path zip_;
-    fs::path filename_;
+    std::vector<fs::path> filenames_;
+    boost::optional<fs::path> destination_;
+    std::size_t jobs_ = 1;
 };
 
 void Zip::configuration(po::options_description &cmdline
@@ -73,19 +77,31 @@ void Zip::configuration(po::options_description &cmdline
     cmdline.add_options()
         ("zip,f", po::value(&zip_)->required()
          , "Zip file.")
-        ("filename", po::value(&filename_)->required()
-         , "File to extract.")
+        ("filename", po::value(&filenames_)
+         , "File to extract, can be used multiple times. All files are "
+         "extracted when omitted and --destination is used.")
+        ("destination,d", po::value<fs::path>()
+         , "Extract files into this directory instead of writing single file "
+         "to standard output.")
+        ("jobs,j", po::value(&jobs_)->default_value(jobs_)->required()
+         , "Number of threads used for extraction into destination "
+         "directory, 0 means number of CPUs.")
         ;
 
     pd.add("zip", 1)
-        .add("filename", 1);
+        .add("filename", -1);
 
     (void) config;
 }
 
 void Zip::configure(const po::variables_map &vars)
 {
-    (void) vars;
+    if (vars.count("destination")) {
+        destination_ = vars["destination"].as<fs::path>();
+    } else if (filenames_.size() != 1) {
+        throw po::validation_error
+            (po::validation_error::invalid_option_value, "filename");
+    }
 }
 
 bool Zip::help(std::ostream &out, const std::string &what) const
@@ -94,34 +110,52 @@ bool Zip::help(std::ostream &out, const std::string &what) const
         out << R"RAW(utility-unzip
 usage
     utility-unzip ZIP-FILE FILENAME [OPTIONS]
+    utility-unzip ZIP-FILE [FILENAME...] --destination DIR [--jobs N] [OPTIONS]
 
 )RAW";
     }
     return false;
 }
 
+int Zip::extract(const utility::zip::Reader &zip)
+{
+    if (filenames_.empty()) {
+        zip.extract(*destination_, jobs_);
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<std::size_t> indices;
+    for (const auto &filename : filenames_) {
+        const auto index(zip.find(filename, std::nothrow));
+        if (!index) {
+            std::cerr << "Cannot find file " << filename
+                      << " in ZIP archive " << zip_ << ".";
+            return EXIT_FAILURE;
+        }
+        indices.push_back(*index);
+    }
+
+    zip.extract(indices, *destination_, jobs_);
+    return EXIT_SUCCESS;
+}
+
 int Zip::run()
 {
     utility::zip::Reader zip(zip_, std::numeric_limits<std::size_t>::max()
                              , false);
 
-    const utility::zip::Reader::Record *record(nullptr);
-
-    for (const auto &r : zip.files()) {
-        if (r.path == filename_) {
-            record = &r;
-            break;
-        }
-    }
+    if (destination_) { return extract(zip); }
 
-    if (!record) {
-        std::cerr << "Cannot find file " << filename_ << " in ZIP archive "
+    const auto &filename(filenames_.front());
+    const auto index(zip.find(filename, std::nothrow));
+    if (!index) {
+        std::cerr << "Cannot find file " << filename << " in ZIP archive "
                   << zip_ << ".";
         return EXIT_FAILURE;
     }
 
     boost::iostreams::filtering_istream ifs;
-    zip.plug(record->index, ifs);
+    zip.plug(*index, ifs);
     ifs.exceptions(std::ios::badbit | std::ios::failbit);
 
     std::cout << ifs.rdbuf() << std::flush;
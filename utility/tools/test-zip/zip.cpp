@@ -25,6 +25,7 @@
  */
 #include <cstdlib>
 #include <iostream>
+#include <mutex>
 
 #include <boost/filesystem.hpp>
 
@@ -32,6 +33,7 @@
 #include "utility/gccversion.hpp"
 #include "utility/streams.hpp"
 #include "utility/zip.hpp"
+#include "utility/parallel.hpp"
 
 #include "service/cmdline.hpp"
 
@@ -71,6 +73,8 @@ private:
     boost::optional<fs::path> cdir_;
     bool verbose_;
     utility::zip::Compression method_;
+    int level_ = utility::zip::Writer::DefaultLevel;
+    std::size_t jobs_ = 1;
 };
 
 void Zip::configuration(po::options_description &cmdline
@@ -90,6 +94,10 @@ void Zip::configuration(po::options_description &cmdline
          , utility::concat
          ("Compression method, one of "
           , enumerationString(method_), ".").c_str())
+        ("level", po::value(&level_)
+         , "Compression level, compressor's default if not set.")
+        ("jobs,j", po::value(&jobs_)->default_value(jobs_)->required()
+         , "Number of files compressed in parallel.")
         ;
 
     pd.add("zip", 1)
@@ -119,51 +127,66 @@ usage
     return false;
 }
 
-void copy(const fs::path &path
-          , const utility::zip::Writer::OStream::pointer &os)
-{
-    utility::ifstreambuf is(path.string());
-    os->get() << is.rdbuf();
-    os->close();
-}
-
 class Packer {
 public:
     Packer(utility::zip::Writer zip
-           , utility::zip::Compression method, bool verbose)
-        : zip_(zip), method_(method), verbose_(verbose)
+           , utility::zip::Compression method, int level, bool verbose)
+        : zip_(zip), method_(method), level_(level), verbose_(verbose)
     {}
 
     void add(const fs::path &file);
 
+    /** Stores all added files using given number of threads.
+     */
+    void pack(std::size_t jobs);
+
 private:
     void store(const fs::path &file);
 
     utility::zip::Writer zip_;
     const utility::zip::Compression method_;
+    const int level_;
     const bool verbose_;
+    std::vector<fs::path> files_;
+    std::mutex mutex_;
 };
 
 void Packer::store(const fs::path &file)
 {
     if (verbose_) {
+        std::unique_lock<std::mutex> lock(mutex_);
         std::cout << file.string() << '\n';
     }
-    copy(file, zip_.ostream(file, method_));
-    return;
+    zip_.addFile(file, file, method_, level_);
 }
 
 void Packer::add(const fs::path &file)
 {
     if (!fs::is_directory(file)) {
-        store(file);
+        files_.push_back(file);
         return;
     }
 
     for (fs::recursive_directory_iterator i(file), e; i != e; ++i) {
         const auto &path(i->path());
-        if (!fs::is_directory(path)) { store(path); }
+        if (!fs::is_directory(path)) { files_.push_back(path); }
+    }
+}
+
+void Packer::pack(std::size_t jobs)
+{
+    if (jobs <= 1) {
+        for (const auto &file : files_) { store(file); }
+        return;
     }
+
+    // multiple files are compressed at once
+    zip_.concurrent();
+
+    utility::parallelFor(files_.size(), jobs, [&](std::size_t index)
+    {
+        store(files_[index]);
+    });
 }
 
 int Zip::run()
@@ -175,8 +198,9 @@ int Zip::run()
         fs::current_path(*cdir_);
     }
 
-    Packer packer(zip, method_, verbose_);
+    Packer packer(zip, method_, level_, verbose_);
     for (const auto &file : files_) { packer.add(file); }
+    packer.pack(jobs_);
 
     zip.close();
 
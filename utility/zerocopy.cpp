@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+#include "dbglog/dbglog.hpp"
+
+#include "unistd_compat.hpp"
+#include "zerocopy.hpp"
+
+namespace utility {
+
+namespace detail {
+
+void copyRangeReadWrite(const Filedes &in, std::uint64_t offset
+                        , std::size_t size, const Filedes &out)
+{
+    std::vector<char> buffer(std::min(size, std::size_t(1) << 20));
+
+    while (size) {
+        auto bytes(::pread(in, buffer.data()
+                           , std::min(size, buffer.size()), offset));
+        if (bytes == -1) {
+            if (errno == EINTR) { continue; }
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Cannot read from file " << in.path() << ": <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+
+        if (!bytes) {
+            LOGTHROW(err2, std::runtime_error)
+                << "File " << in.path() << " is shorter than expected.";
+        }
+
+        offset += bytes;
+        size -= bytes;
+
+        for (const char *data(buffer.data()); bytes; ) {
+            const auto written(::write(out, data, bytes));
+            if (written == -1) {
+                if (errno == EINTR) { continue; }
+                std::system_error e(errno, std::system_category());
+                LOG(err2) << "Cannot write to file " << out.path() << ": <"
+                          << e.code() << ", " << e.what() << ">.";
+                throw e;
+            }
+            data += written;
+            bytes -= written;
+        }
+    }
+}
+
+} // namespace detail
+
+} // namespace utility
@@ -0,0 +1,60 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_zerocopy_hpp_included_
+#define utility_zerocopy_hpp_included_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "filedes.hpp"
+
+namespace utility {
+
+/** Copies size bytes starting at given offset of input file to current
+ *  position of output file. Output file position is advanced, input file
+ *  position is left untouched.
+ *
+ *  Data are moved inside the kernel if possible (copy_file_range, sendfile),
+ *  plain read/write loop is used otherwise.
+ *
+ *  Throws std::system_error on I/O error and std::runtime_error when input
+ *  file ends before size bytes are copied.
+ */
+void copyRange(const Filedes &in, std::uint64_t offset, std::size_t size
+               , const Filedes &out);
+
+namespace detail {
+
+/** Portable read/write implementation of copyRange.
+ */
+void copyRangeReadWrite(const Filedes &in, std::uint64_t offset
+                        , std::size_t size, const Filedes &out);
+
+} // namespace detail
+
+} // namespace utility
+
+#endif // utility_zerocopy_hpp_included_
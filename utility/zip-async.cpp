@@ -0,0 +1,147 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <system_error>
+
+#include <boost/asio/post.hpp>
+
+#include "dbglog/dbglog.hpp"
+
+#include "zip-async.hpp"
+#include "cpuinfo.hpp"
+#include "format.hpp"
+
+namespace utility { namespace zip {
+
+namespace {
+
+void complete(boost::asio::io_context &ioc
+              , const AsyncReader::Callback &callback
+              , AsyncReader::Result &&result)
+{
+    boost::asio::post(ioc, [callback, result]() mutable
+    {
+        callback(std::move(result));
+    });
+}
+
+} // namespace
+
+AsyncReader::AsyncReader(std::size_t threads, std::size_t queueLimit)
+    : queueLimit_(queueLimit), running_(true)
+{
+    if (!threads) { threads = utility::cpuCount(); }
+
+    for (std::size_t id(1); id <= threads; ++id) {
+        workers_.emplace_back(&AsyncReader::worker, this, id);
+    }
+}
+
+AsyncReader::~AsyncReader()
+{
+    std::deque<Operation> cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        std::swap(cancelled, queue_);
+    }
+    cond_.notify_all();
+
+    for (auto &thread : workers_) { thread.join(); }
+
+    for (auto &op : cancelled) {
+        complete(*op.ioc, op.callback
+                 , Result(std::make_error_code
+                          (std::errc::operation_canceled)));
+    }
+}
+
+void AsyncReader::asyncRead(std::shared_ptr<const Reader> reader
+                            , std::size_t index
+                            , boost::asio::io_context &ioc
+                            , Callback callback)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) {
+            // no worker would ever pick this operation up
+            complete(ioc, callback
+                     , Result(std::make_error_code
+                              (std::errc::operation_canceled)));
+            return;
+        }
+
+        if (queue_.size() < queueLimit_) {
+            queue_.push_back(Operation{ std::move(reader), index, &ioc
+                                        , std::move(callback) });
+            cond_.notify_one();
+            return;
+        }
+    }
+
+    LOG(warn2) << "Async zip read queue is full, refusing to read file "
+               << index << ".";
+    complete(ioc, callback
+             , Result(std::make_exception_ptr
+                      (Error("Async zip read queue is full."))));
+}
+
+std::size_t AsyncReader::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void AsyncReader::worker(std::size_t id)
+{
+    dbglog::thread_id(utility::format("zip:%u", id));
+
+    for (;;) {
+        Operation op;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+            if (!running_) { return; }
+            op = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        complete(*op.ioc, op.callback, read(*op.reader, op.index));
+    }
+}
+
+AsyncReader::Result AsyncReader::read(const Reader &reader
+                                      , std::size_t index)
+{
+    try {
+        return Result(std::make_shared<const std::vector<char>>
+                      (reader.read(index)));
+    } catch (...) {
+        return Result(std::current_exception());
+    }
+}
+
+} } // namespace utility::zip
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_zip_async_hpp_included_
+#define utility_zip_async_hpp_included_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include <boost/noncopyable.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "zip.hpp"
+#include "expected.hpp"
+
+namespace utility { namespace zip {
+
+/** Asynchronous reads of files from ZIP archives for asio based servers (see
+ *  utility::IoThreads).
+ *
+ *  Reading and decompression is performed on a bounded pool of blocking
+ *  worker threads owned by this object, result is posted back to the
+ *  io_context given by the caller. I/O threads therefore never block on disk.
+ *
+ *  Pending operations are bounded as well: when the queue is full new
+ *  operation is failed immediately (via the callback, as any other error).
+ *  Operations still pending when AsyncReader is destroyed are cancelled with
+ *  std::errc::operation_canceled, the same error is reported for operations
+ *  submitted while AsyncReader is being destroyed.
+ *
+ *  Available only when compiled as C++14 or newer (see utility::Expected).
+ */
+class AsyncReader : boost::noncopyable {
+public:
+    typedef std::shared_ptr<const std::vector<char>> Buffer;
+    typedef utility::Expected<Buffer> Result;
+
+    /** Completion callback. Always called from the io_context.
+     */
+    typedef std::function<void(Result &&result)> Callback;
+
+    /**
+     * \param threads number of blocking worker threads, 0 means number of CPUs
+     * \param queueLimit maximum number of pending operations
+     */
+    AsyncReader(std::size_t threads = 0, std::size_t queueLimit = 1024);
+
+    ~AsyncReader();
+
+    /** Reads whole content of file at given index. Reader is kept alive
+     *  until the operation completes.
+     */
+    void asyncRead(std::shared_ptr<const Reader> reader, std::size_t index
+                   , boost::asio::io_context &ioc, Callback callback);
+
+    /** Number of pending (not yet started) operations.
+     */
+    std::size_t pending() const;
+
+private:
+    struct Operation {
+        std::shared_ptr<const Reader> reader;
+        std::size_t index;
+        boost::asio::io_context *ioc;
+        Callback callback;
+    };
+
+    void worker(std::size_t id);
+
+    /** Reads file in the calling thread.
+     */
+    static Result read(const Reader &reader, std::size_t index);
+
+    const std::size_t queueLimit_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Operation> queue_;
+    bool running_;
+
+    std::vector<std::thread> workers_;
+};
+
+} } // namespace utility::zip
+
+#endif // utility_zip_async_hpp_included_
@@ -0,0 +1,171 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fcntl.h>
+
+#include <algorithm>
+#include <system_error>
+
+#include "utility/unistd_compat.hpp"
+#include "dbglog/dbglog.hpp"
+
+#include "zip-cache.hpp"
+#include "rlimit.hpp"
+
+namespace fs = boost::filesystem;
+
+namespace utility { namespace zip {
+
+namespace {
+
+std::size_t fdBudget(std::size_t requested)
+{
+    // leave half of available descriptors to the rest of the process
+    const auto limit(std::max(maxOpenFiles() / 2, std::size_t(1)));
+    return requested ? std::min(requested, limit) : limit;
+}
+
+Filedes openArchive(const fs::path &path)
+{
+    Filedes fd(::open(path.string().c_str(), O_RDONLY), path);
+    if (!fd) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot open zip file " << path << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+    return fd;
+}
+
+} // namespace
+
+ReaderCache::ReaderCache(const Options &options)
+    : options_(options)
+{
+    options_.fdBudget = fdBudget(options_.fdBudget);
+}
+
+ReaderCache::ReaderPointer ReaderCache::get(const fs::path &path)
+{
+    const auto key(path.string());
+    const auto fileKey(FileKey::from(path));
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto iindex(index_.find(key));
+        if (iindex != index_.end()) {
+            const auto ientry(iindex->second);
+            if (ientry->fileKey == fileKey) {
+                entries_.splice(entries_.end(), entries_, ientry);
+                ++stats_.hits;
+                return ientry->reader;
+            }
+
+            LOG(info1) << "Zip file " << path << " has changed, reopening.";
+            ++stats_.invalidations;
+            remove(ientry);
+        }
+        ++stats_.misses;
+    }
+
+    // open outside of lock; stat the open file itself to catch replacement
+    // between the stat above and the open
+    auto fd(openArchive(path));
+    const auto openKey(FileKey::from(int(fd)));
+    auto reader(std::make_shared<const Reader>
+                (std::move(fd), options_.readerOptions));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // someone else could have been faster
+    auto iindex(index_.find(key));
+    if (iindex != index_.end()) {
+        const auto ientry(iindex->second);
+        if (ientry->fileKey == openKey) {
+            entries_.splice(entries_.end(), entries_, ientry);
+            return ientry->reader;
+        }
+        remove(ientry);
+    }
+
+    entries_.push_back(Entry{ path, openKey, reader
+                              , reader->memoryUsage(), 1 });
+    index_[key] = std::prev(entries_.end());
+    stats_.memory += entries_.back().memory;
+    stats_.fds += entries_.back().fds;
+    ++stats_.size;
+
+    trim();
+
+    return reader;
+}
+
+void ReaderCache::invalidate(const fs::path &path)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iindex(index_.find(path.string()));
+    if (iindex == index_.end()) { return; }
+    ++stats_.invalidations;
+    remove(iindex->second);
+}
+
+void ReaderCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    stats_.size = stats_.memory = stats_.fds = 0;
+}
+
+ReaderCache::Statistics ReaderCache::statistics() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void ReaderCache::remove(EntryList::iterator ientry)
+{
+    stats_.memory -= ientry->memory;
+    stats_.fds -= ientry->fds;
+    --stats_.size;
+    index_.erase(ientry->path.string());
+    entries_.erase(ientry);
+}
+
+void ReaderCache::trim()
+{
+    while ((entries_.size() > 1)
+           && ((stats_.memory > options_.memoryBudget)
+               || (stats_.fds > options_.fdBudget)))
+    {
+        LOG(info1) << "Evicting zip file " << entries_.front().path
+                   << " from reader cache.";
+        ++stats_.evictions;
+        remove(entries_.begin());
+    }
+}
+
+} } // namespace utility::zip
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) 2026 Melown Technologies SE
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * *  Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ * *  Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef utility_zip_cache_hpp_included_
+#define utility_zip_cache_hpp_included_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+
+#include <boost/noncopyable.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include "zip.hpp"
+#include "filesystem.hpp"
+
+namespace utility { namespace zip {
+
+/** ZIP reader cache options.
+ */
+struct ReaderCacheOptions {
+    /** Memory budget in bytes.
+     */
+    std::size_t memoryBudget = std::size_t(64) << 20;
+
+    /** Open file descriptor budget. Always capped at half of
+     *  utility::maxOpenFiles() (which is also the default when zero).
+     */
+    std::size_t fdBudget = 0;
+
+    /** Options used to open readers.
+     */
+    ReaderOptions readerOptions;
+};
+
+/** Shared cache of open ZIP readers.
+ *
+ *  Readers are cached by archive path and validated by precise file identity
+ *  (see utility::FileKey) on every access: changed file is reopened
+ *  automatically, even when rewritten in place within the same second.
+ *  Cached readers are kept under two budgets: heap memory occupied by parsed
+ *  central directories (see Reader::memoryUsage()) and number of open file
+ *  descriptors. Least recently used readers are evicted first.
+ *
+ *  Readers are handed out as shared pointers: evicted reader lives (and keeps
+ *  its file descriptor open) until last user releases it.
+ *
+ *  All operations are thread safe.
+ */
+class ReaderCache : boost::noncopyable {
+public:
+    typedef std::shared_ptr<const Reader> ReaderPointer;
+
+    typedef ReaderCacheOptions Options;
+
+    struct Statistics {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t invalidations = 0;
+        std::size_t evictions = 0;
+
+        /** Current state.
+         */
+        std::size_t size = 0;
+        std::size_t memory = 0;
+        std::size_t fds = 0;
+    };
+
+    ReaderCache(const Options &options = Options());
+
+    /** Returns reader for given archive. Archive is (re)opened if not cached
+     *  or if it has changed since it was opened.
+     */
+    ReaderPointer get(const boost::filesystem::path &path);
+
+    /** Drops cached reader for given archive, if any.
+     */
+    void invalidate(const boost::filesystem::path &path);
+
+    /** Drops all cached readers.
+     */
+    void clear();
+
+    Statistics statistics() const;
+
+    const Options& options() const { return options_; }
+
+private:
+    struct Entry {
+        boost::filesystem::path path;
+        FileKey fileKey;
+        ReaderPointer reader;
+        std::size_t memory;
+        std::size_t fds;
+    };
+
+    typedef std::list<Entry> EntryList;
+
+    /** Removes given entry. Must be called under lock.
+     */
+    void remove(EntryList::iterator ientry);
+
+    /** Evicts LRU entries until under budget, keeps the most recent one.
+     *  Must be called under lock.
+     */
+    void trim();
+
+    Options options_;
+
+    mutable std::mutex mutex_;
+
+    /** Entries in LRU order, most recently used at the end.
+     */
+    EntryList entries_;
+    std::unordered_map<std::string, EntryList::iterator> index_;
+
+    Statistics stats_;
+};
+
+} } // namespace utility::zip
+
+#endif // utility_zip_cache_hpp_included_
@@ -29,6 +29,14 @@
 #include <fcntl.h>
 
 #include <ctime>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <system_error>
 
 #include <boost/utility/in_place_factory.hpp>
@@ -36,10 +44,18 @@
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/filter/bzip2.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
+#if UTILITY_HAS_ZSTD
+#  include <boost/iostreams/filter/zstd.hpp>
+#endif
+#if UTILITY_HAS_ZLIB
+#  include <zlib.h>
+#endif
 #include <boost/iostreams/device/array.hpp>
-#include <boost/crc.hpp>
+#include <boost/iostreams/device/null.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include "utility/unistd_compat.hpp"
+#include "utility/cppversion.hpp"
 #include "dbglog/dbglog.hpp"
 
 #include "binaryio.hpp"
@@ -50,6 +66,12 @@
 #include "scopedguard.hpp"
 #include "typeinfo.hpp"
 #include "raise.hpp"
+#include "cpuinfo.hpp"
+#include "crc32.hpp"
+#include "zerocopy.hpp"
+#include "filesystem.hpp"
+#include "parallel.hpp"
+#include "detail/sidecar.hpp"
 
 /*
 Format documentation (Library of Congress preserved version):
@@ -160,19 +182,26 @@ constexpr std::uint32_t CENTRAL_DIRECTORY_FILE_HEADER_SIGNATURE = 0x02014b50;
 constexpr std::uint32_t END_OF_CENTRAL_DIRECTORY_SIGNATURE = 0x06054b50;
 constexpr std::uint32_t END_OF_CENTRAL_DIRECTORY64_SIGNATURE = 0x06064b50;
 constexpr std::uint32_t END_OF_CENTRAL_DIRECTORY64_LOCATOR_SIGNATURE = 0x07064b50;
+constexpr std::uint32_t DATA_DESCRIPTOR_SIGNATURE = 0x08074b50;
 
 
 /** 64-bit support + bzip2
  */
 constexpr std::uint16_t VERSION_NEEDED = 46;
 
+/** Zstandard compression
+ */
+constexpr std::uint16_t VERSION_NEEDED_ZSTD = 63;
+
 /** UNIX (3) + version 6.3 (3f = 63)
  */
 constexpr std::uint16_t VERSION_MADE_BY = 0x33f;
 
 constexpr std::uint16_t Tag64 = 0x0001u;
 
+constexpr std::uint16_t FlagEncrypted = 1u << 0;
 constexpr std::uint16_t FlagDataDescriptor = 1u << 3;
+constexpr std::uint16_t FlagStrongEncryption = 1u << 6;
 
 /** Should be used only for uint16 and uint32
  */
@@ -219,17 +248,61 @@ void readVector(std::istream &is, std::vector<char> &vec, std::size_t size)
     is.read(&vec[0], size);
 }
 
-void readString(std::istream &is, std::string &str, std::size_t size)
+void checkSignature(const std::string &what, std::istream &in
+                    , const std::uint32_t expect)
 {
-    std::vector<char> tmp;
-    readVector(is, tmp, size);
-    str.assign(tmp.begin(), tmp.end());
+    const auto signature(bin::read<std::uint32_t>(in));
+    if (signature != expect) {
+        LOGTHROW(err1, BadSignature)
+            << "Error reading " << what << ": invalid signature;"
+            << " expected 0x" << std::setfill('0')
+            << std::hex << std::setw(8) << expect
+            << " got 0x"
+            << std::hex << std::setw(8) << signature
+            << ".";
+    }
 }
 
-void checkSignature(const std::string &what, std::istream &in
+/** Sequential reader of little-endian binary data from memory buffer.
+ */
+class BufferReader {
+public:
+    BufferReader(const char *data, std::size_t size)
+        : data_(data), end_(data + size)
+    {}
+
+    template <typename T> T read() {
+        T value;
+        std::memcpy(&value, skip(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T> void read(T &value) { value = read<T>(); }
+
+    /** Skips given number of bytes. Returns pointer to skipped data.
+     */
+    const char* skip(std::size_t size) {
+        if (size > left()) {
+            LOGTHROW(err2, Error)
+                << "Unexpected end of data: requested " << size
+                << " bytes but only " << left() << " bytes left.";
+        }
+        const auto data(data_);
+        data_ += size;
+        return data;
+    }
+
+    std::size_t left() const { return end_ - data_; }
+
+private:
+    const char *data_;
+    const char *end_;
+};
+
+void checkSignature(const std::string &what, BufferReader &in
                     , const std::uint32_t expect)
 {
-    const auto signature(bin::read<std::uint32_t>(in));
+    const auto signature(in.read<std::uint32_t>());
     if (signature != expect) {
         LOGTHROW(err1, BadSignature)
             << "Error reading " << what << ": invalid signature;"
@@ -272,6 +345,8 @@ enum class CompressionMethod : std::uint16_t {
     , lzma = 14
     , terse = 18
     , lz77 = 19
+    , zstdDeprecated = 20
+    , zstd = 93
     , wavpack = 97
     , ppmd = 98
 };
@@ -291,6 +366,8 @@ UTILITY_GENERATE_ENUM_IO(CompressionMethod,
                          ((lzma))
                          ((terse))
                          ((lz77))
+                         ((zstdDeprecated))
+                         ((zstd))
                          ((wavpack))
                          ((ppmd))
                          )
@@ -309,6 +386,26 @@ localFileHeaderSize(sizeof(std::uint32_t)
                     + sizeof(std::uint16_t)
                     );
 
+const std::size_t
+centralDirectoryFileHeaderSize(sizeof(std::uint32_t)
+                               + sizeof(std::uint16_t) // versionMadeBy
+                               + sizeof(std::uint16_t) // versionNeeded
+                               + sizeof(std::uint16_t) // flag
+                               + sizeof(std::uint16_t) // compressionMethod
+                               + sizeof(std::uint16_t) // modificationTime
+                               + sizeof(std::uint16_t) // modificationDate
+                               + sizeof(std::uint32_t) // crc32
+                               + sizeof(std::uint32_t) // compressedSize
+                               + sizeof(std::uint32_t) // uncompressedSize
+                               + sizeof(std::uint16_t) // filenameSize
+                               + sizeof(std::uint16_t) // fileExtraSize
+                               + sizeof(std::uint16_t) // fileCommentSize
+                               + sizeof(std::uint16_t) // diskNumberStart
+                               + sizeof(std::uint16_t) // internalAttributes
+                               + sizeof(std::uint32_t) // externalAttributes
+                               + sizeof(std::uint32_t) // fileOffset
+                               );
+
 const std::size_t maxFilenameSize(std::numeric_limits<std::uint16_t>::max());
 const std::size_t maxExtraSize(std::numeric_limits<std::uint16_t>::max());
 
@@ -347,6 +444,7 @@ struct CentralDirectoryFileHeader {
         MinimalFileHeader mh;
         mh.flag = flag;
         mh.compressionMethod = compressionMethod;
+        mh.crc32 = crc32;
         mh.compressedSize = compressedSize;
         mh.uncompressedSize = uncompressedSize;
         mh.filenameSize = filename.size();
@@ -354,7 +452,7 @@ struct CentralDirectoryFileHeader {
         return mh;
     }
 
-    static CentralDirectoryFileHeader read(std::istream &in);
+    static CentralDirectoryFileHeader read(BufferReader &in);
 };
 
 struct EndOfCentralDirectoryRecord {
@@ -467,6 +565,53 @@ void readExtra64(std::istream &in, int extraSize
     in.seekg(skip, std::ios_base::beg);
 }
 
+void readExtra64(BufferReader &in, std::size_t extraSize
+                 , std::uint64_t &uncompressedSize
+                 , std::uint64_t &compressedSize
+                 , std::uint64_t *fileOffset = nullptr
+                 , std::uint32_t *diskNumberStart = nullptr)
+{
+    const auto headerSize(2 * sizeof(std::uint16_t));
+
+    // extra data are processed in its own reader
+    BufferReader extra(in.skip(extraSize), extraSize);
+
+    // read stuff from extra data
+    while (extra.left() >= headerSize) {
+        const auto tag(extra.read<std::uint16_t>());
+        const auto size(extra.read<std::uint16_t>());
+
+        if (tag != Tag64) {
+            // skip
+            extra.skip(size);
+            continue;
+        }
+
+        // 64bit info -> read
+        BufferReader tag64(extra.skip(size), size);
+
+        // read only fields that are marked invalid
+        if (invalid<std::uint32_t>(uncompressedSize)) {
+            tag64.read(uncompressedSize);
+        }
+
+        if (invalid<std::uint32_t>(compressedSize)) {
+            tag64.read(compressedSize);
+        }
+
+        if (fileOffset && invalid<std::uint32_t>(*fileOffset)) {
+            tag64.read(*fileOffset);
+        }
+
+        if (diskNumberStart && invalid<std::uint16_t>(*diskNumberStart)) {
+            tag64.read(*diskNumberStart);
+        }
+
+        // no need to continue
+        break;
+    }
+}
+
 inline std::size_t MinimalFileHeader::size() const
 {
     return localFileHeaderSize + filenameSize + fileExtraSize;
@@ -475,12 +620,12 @@ inline std::size_t MinimalFileHeader::size() const
 void MinimalFileHeader::read(std::istream &in)
 {
     checkSignature("local file header", in, LOCAL_HEADER_SIGNATURE);
-    bin::read<std::uint16_t>(in); // version needed to extract
+    bin::read(in, versionNeeded);
     flag = bin::read<std::uint16_t>(in); // general purpose bit flag
     bin::read(in, compressionMethod);
-    bin::read<std::uint16_t>(in); // last modification time
-    bin::read<std::uint16_t>(in); // last modification date
-    bin::read<std::uint32_t>(in); // crc-32
+    bin::read(in, modificationTime);
+    bin::read(in, modificationDate);
+    bin::read(in, crc32);
     compressedSize = bin::read<std::uint32_t>(in);
     uncompressedSize = bin::read<std::uint32_t>(in);
     bin::read(in, filenameSize);
@@ -500,39 +645,43 @@ inline void updateHeader(MinimalFileHeader &header
 
     header.compressedSize = other.compressedSize;
     header.uncompressedSize = other.uncompressedSize;
-    // CRC not used
+    header.crc32 = other.crc32;
 }
 
-CentralDirectoryFileHeader CentralDirectoryFileHeader::read(std::istream &in)
+CentralDirectoryFileHeader CentralDirectoryFileHeader::read(BufferReader &in)
 {
     checkSignature("central directory file header", in
                    , CENTRAL_DIRECTORY_FILE_HEADER_SIGNATURE);
 
     CentralDirectoryFileHeader h;
 
-    bin::read(in, h.versionMadeBy);
-    bin::read(in, h.versionNeeded);
-    bin::read(in, h.flag);
-    bin::read(in, h.compressionMethod);
-    bin::read(in, h.modificationTime);
-    bin::read(in, h.modificationDate);
-    bin::read(in, h.crc32);
-    h.compressedSize = bin::read<std::uint32_t>(in);
-    h.uncompressedSize = bin::read<std::uint32_t>(in);
-
-    const auto filenameSize(bin::read<std::uint16_t>(in));
-    const auto fileExtraSize(bin::read<std::uint16_t>(in));
-    const auto fileCommentSize(bin::read<std::uint16_t>(in));
+    in.read(h.versionMadeBy);
+    in.read(h.versionNeeded);
+    in.read(h.flag);
+    in.read(h.compressionMethod);
+    in.read(h.modificationTime);
+    in.read(h.modificationDate);
+    in.read(h.crc32);
+    h.compressedSize = in.read<std::uint32_t>();
+    h.uncompressedSize = in.read<std::uint32_t>();
 
-    h.diskNumberStart = bin::read<std::uint16_t>(in);
-    bin::read(in, h.internalFileAttributes);
-    bin::read(in, h.externalFileAttributes);
-    h.fileOffset = bin::read<std::uint32_t>(in);
+    const auto filenameSize(in.read<std::uint16_t>());
+    const auto fileExtraSize(in.read<std::uint16_t>());
+    const auto fileCommentSize(in.read<std::uint16_t>());
+
+    h.diskNumberStart = in.read<std::uint16_t>();
+    in.read(h.internalFileAttributes);
+    in.read(h.externalFileAttributes);
+    h.fileOffset = in.read<std::uint32_t>();
+
+    const auto filename(in.skip(filenameSize));
+    h.filename.assign(filename, filename + filenameSize);
 
-    readString(in, h.filename, filenameSize);
     readExtra64(in, fileExtraSize, h.compressedSize, h.uncompressedSize
                 , &h.fileOffset, &h.diskNumberStart);
-    readVector(in, h.fileComment, fileCommentSize);
+
+    const auto comment(in.skip(fileCommentSize));
+    h.fileComment.assign(comment, comment + fileCommentSize);
 
     return h;
 }
@@ -729,26 +878,51 @@ int findCentralDirectory(Stream &f, std::size_t fileLength)
     return off;
 }
 
+/** Reads whole ZIP central directory.
+ *
+ *  End of central directory records are read via stream, central directory
+ *  itself is loaded in one go (or taken from memory mapped archive) and
+ *  parsed directly from memory.
+ */
 class CentralDirectoryReader {
 public:
     CentralDirectoryReader(const Filedes &fd)
-        : path_(fd.path()), fileLength_(fileSize(fd))
-        , f_(utility::io::SubStreamDevice
-             (path_, utility::io::SubStreamDevice::Filedes
-              { int(fd), std::size_t(0), fileLength_}), 512)
+        : path_(fd.path()), fd_(fd), fileLength_(fileSize(fd))
+        , memory_()
+        , f_(stream())
     {}
 
-    CentralDirectoryReader(const Filedes &fd, std::size_t fileLength)
-        : path_(fd.path()), fileLength_(fileLength)
-        , f_(utility::io::SubStreamDevice
-             (path_, utility::io::SubStreamDevice::Filedes
-              { int(fd), std::size_t(0), fileLength_}), 512)
+    /** Reads central directory of file with known length. If memory is
+     *  provided it must hold whole file and file descriptor is not used at
+     *  all.
+     */
+    CentralDirectoryReader(const fs::path &path, const Filedes &fd
+                           , std::size_t fileLength
+                           , const char *memory = nullptr)
+        : path_(path), fd_(fd), fileLength_(fileLength)
+        , memory_(memory)
+        , f_(stream())
     {}
 
+    /** Number of records in the central directory. Valid after open().
+     *
+     *  Clamped to the number of records the central directory (and the
+     *  file) can physically hold so that a bogus count cannot trigger a
+     *  huge allocation.
+     */
+    std::size_t size() const {
+        const auto space(std::min<std::uint64_t>
+                         (eocd_.sizeOfCentralDirectory, fileLength_));
+        return std::min<std::uint64_t>
+            (eocd_.numberOfCentralDirectoryRecordsOnThisDisk
+             , space / centralDirectoryFileHeaderSize);
+    }
+
     bool open(bool nothrow = false) {
-        f_.exceptions(std::ios::badbit | std::ios::failbit);
+        auto &f(*f_);
+        f.exceptions(std::ios::badbit | std::ios::failbit);
 
-        auto off(findCentralDirectory(f_, fileLength_));
+        auto off(findCentralDirectory(f, fileLength_));
 
         if (off < 0) {
             if (nothrow) { return false; }
@@ -757,16 +931,16 @@ public:
                 "in zip file " << path_ << ".";
         }
 
-        f_.seekg(-off, std::ios_base::end);
-        eocd_ = EndOfCentralDirectoryRecord::read(f_);
+        f.seekg(-off, std::ios_base::end);
+        eocd_ = EndOfCentralDirectoryRecord::read(f);
 
         if (eocd_.has64locator()) {
             // seek to locator and read
-            f_.seekg(-off - EndOfCentralDirectory64Locator::size()
+            f.seekg(-off - EndOfCentralDirectory64Locator::size()
                     , std::ios_base::end);
-            const auto locator(EndOfCentralDirectory64Locator::read(f_));
-            f_.seekg(locator.endOfCentralDirectoryOffset, std::ios_base::beg);
-            eocd_ = EndOfCentralDirectoryRecord::read64(f_);
+            const auto locator(EndOfCentralDirectory64Locator::read(f));
+            f.seekg(locator.endOfCentralDirectoryOffset, std::ios_base::beg);
+            eocd_ = EndOfCentralDirectoryRecord::read64(f);
         }
 
         return true;
@@ -785,12 +959,28 @@ public:
                    << eocd_.numberOfCentralDirectoryRecordsOnThisDisk
                    << " from ZIP archive " << path_ << ".";
 
-        // seek to first central directory record
-        f_.seekg(eocd_.centralDirectoryOffset, std::ios_base::beg);
+        const auto start(eocd_.centralDirectoryOffset);
+        const auto size(eocd_.sizeOfCentralDirectory);
+        if ((start > fileLength_) || (size > (fileLength_ - start))) {
+            LOGTHROW(err2, Error)
+                << "Central directory lies past the end of zip file "
+                << path_ << ".";
+        }
+
+        // grab whole central directory at once
+        std::vector<char> buffer;
+        const char *data(memory_ ? (memory_ + start) : nullptr);
+        if (!data) {
+            buffer.resize(size);
+            load(buffer.data(), size, start);
+            data = buffer.data();
+        }
+
+        BufferReader cd(data, size);
 
         // read central directory
         for (std::size_t i(0); i != recordCount; ++i) {
-            auto cdfh(CentralDirectoryFileHeader::read(f_));
+            auto cdfh(CentralDirectoryFileHeader::read(cd));
 
             if (cdfh.diskNumberStart != eocd_.numberOfThisDisk) {
                 LOGTHROW(err2, Error)
@@ -803,9 +993,53 @@ public:
     }
 
 private:
+    /** Stream for reading end of central directory records: either from
+     *  memory or from file.
+     */
+    std::unique_ptr<std::istream> stream() const {
+        if (memory_) {
+            return std::make_unique<bio::stream<bio::array_source>>
+                (memory_, memory_ + fileLength_);
+        }
+
+        return std::make_unique
+            <boost::iostreams::stream<utility::io::SubStreamDevice>>
+            (utility::io::SubStreamDevice
+             (path_, utility::io::SubStreamDevice::Filedes
+              { int(fd_), std::size_t(0), fileLength_}), 512);
+    }
+
+    /** Reads exactly size bytes from given file offset.
+     */
+    void load(char *data, std::size_t size, std::size_t offset) {
+        while (size) {
+            const auto bytes(TEMP_FAILURE_RETRY
+                             (::pread(fd_, data, size, offset)));
+            if (bytes == -1) {
+                std::system_error e(errno, std::system_category());
+                LOG(err2) << "Cannot read central directory of zip file "
+                          << path_ << ": <" << e.code() << ", " << e.what()
+                          << ">.";
+                throw e;
+            }
+
+            if (!bytes) {
+                LOGTHROW(err2, Error)
+                    << "Unexpected end of zip file " << path_
+                    << " while reading central directory.";
+            }
+
+            data += bytes;
+            size -= bytes;
+            offset += bytes;
+        }
+    }
+
     const fs::path path_;
+    const Filedes &fd_;
     const std::size_t fileLength_;
-    boost::iostreams::stream<utility::io::SubStreamDevice> f_;
+    const char *memory_;
+    std::unique_ptr<std::istream> f_;
     EndOfCentralDirectoryRecord eocd_;
 };
 
@@ -832,142 +1066,1257 @@ bool Reader::check(const boost::filesystem::path &path)
     return false;
 }
 
+namespace {
+
+ReaderOptions readerOptions(std::size_t limit, bool sanitizePaths)
+{
+    ReaderOptions options;
+    options.limit = limit;
+    options.sanitizePaths = sanitizePaths;
+    return options;
+}
+
+} // namespace
+
 Reader::Reader(const fs::path &path, std::size_t limit, bool sanitizePaths)
+    : Reader(path, readerOptions(limit, sanitizePaths))
+{}
+
+Reader::Reader(const fs::path &path, const ReaderOptions &options)
     : path_(path), fd_(openFile(path))
     , fileLength_(fileSize(fd_))
 {
+    open(options);
+}
+
+Reader::Reader(Filedes &&fd, const ReaderOptions &options)
+    : path_(fd.path()), fd_(std::move(fd))
+    , fileLength_(fileSize(fd_))
+{
+    if (path_.empty()) {
+        path_ = "<fd " + std::to_string(int(fd_)) + ">";
+    }
+
+    open(options);
+}
+
+Reader::Reader(const MemoryView &memory, const ReaderOptions &options)
+    : path_("<memory>"), fileLength_(memory.size), memory_(memory)
+{
+    // null data would be mistaken for file based archive
+    if (!memory_.data) {
+        LOGTHROW(err2, Error)
+            << "Cannot open zip archive from memory: no memory given.";
+    }
+
+    auto opts(options);
+    opts.mmap = false;
+    open(opts);
+}
+
+void Reader::open(const ReaderOptions &options)
+{
+    const auto limit(options.limit);
+    const auto sanitizePaths(options.sanitizePaths);
+
+    if (options.mmap) {
+        memory_ = std::make_shared<MappedFile>(fd_, fileLength_)->view();
+    } else if (options.blockCache && fd_) {
+        blockCache_ = options.blockCache;
+        blockCacheKey_ = io::BlockCache::key(fd_, path_);
+    }
+
+#if UTILITY_HAS_ZLIB
+    seekIndices_ = std::make_shared<SeekIndices>();
+#endif
+
     try {
         // open and read central directory
-        CentralDirectoryReader cdr(fd_, fileLength_);
+        CentralDirectoryReader cdr(path_, fd_, fileLength_, memory_.data);
         cdr.open();
 
-        cdr.read([&](int i, const CentralDirectoryFileHeader &cdfh) -> void
+        records_.reserve(std::min(cdr.size(), limit));
+
+        cdr.read([&](int, const CentralDirectoryFileHeader &cdfh) -> void
         {
-            records_.emplace_back(i, sanitize(cdfh.filename, sanitizePaths)
-                                  , cdfh.fileOffset, cdfh.minimal());
+            records_.push_back(sanitize(cdfh.filename, sanitizePaths).string()
+                               , cdfh.fileOffset, cdfh.minimal()
+                               , cdfh.externalFileAttributes);
         }, limit);
     } catch (const std::ios_base::failure &e) {
         LOGTHROW(err2, Error)
-            << "Cannot process the zip file " << path << ": " << e.what()
+            << "Cannot process the zip file " << path_ << ": " << e.what()
             << ".";
     }
+
+    records_.shrink_to_fit();
+
+    buildIndex();
 }
 
-std::size_t Reader::find(const boost::filesystem::path &path) const
+void Reader::RecordList::reserve(std::size_t size)
 {
-    auto frecords(std::find_if(records_.begin(), records_.end()
-                               , [&](const Record &r) {
-                                   return r.path == path;
-                               }));
-    if (frecords == records_.end()) {
-        LOGTHROW(err2, Error)
-            << "File " << path << "not found in zip file "
-            << path_ << ".";
-    }
+    pathOffsets_.reserve(size + 1);
+    headerStart_.reserve(size);
+    compressedSize_.reserve(size);
+    uncompressedSize_.reserve(size);
+    crc32_.reserve(size);
+    attributes_.reserve(size);
+    flag_.reserve(size);
+    compressionMethod_.reserve(size);
+    filenameSize_.reserve(size);
+    fileExtraSize_.reserve(size);
+}
+
+void Reader::RecordList::push_back(const std::string &path
+                                   , std::size_t headerStart
+                                   , const MinimalFileHeader &header
+                                   , std::uint32_t attributes)
+{
+    paths_.append(path);
+    pathOffsets_.push_back(paths_.size());
+    headerStart_.push_back(headerStart);
+    compressedSize_.push_back(header.compressedSize);
+    uncompressedSize_.push_back(header.uncompressedSize);
+    crc32_.push_back(header.crc32);
+    attributes_.push_back(attributes);
+    flag_.push_back(header.flag);
+    compressionMethod_.push_back(header.compressionMethod);
+    filenameSize_.push_back(header.filenameSize);
+    fileExtraSize_.push_back(header.fileExtraSize);
+}
 
-    return (&*frecords - records_.data());
+void Reader::RecordList::shrink_to_fit()
+{
+    paths_.shrink_to_fit();
+    pathOffsets_.shrink_to_fit();
+    headerStart_.shrink_to_fit();
+    compressedSize_.shrink_to_fit();
+    uncompressedSize_.shrink_to_fit();
+    crc32_.shrink_to_fit();
+    attributes_.shrink_to_fit();
+    flag_.shrink_to_fit();
+    compressionMethod_.shrink_to_fit();
+    filenameSize_.shrink_to_fit();
+    fileExtraSize_.shrink_to_fit();
 }
 
-PluggedFile Reader::plug(std::size_t index
-                         , boost::iostreams::filtering_istream &fis)
-    const
+namespace {
+
+template <typename T>
+std::size_t vectorMemory(const std::vector<T> &v)
 {
-    if (index >= records_.size())  {
-        LOGTHROW(err2, Error)
-            << "Invalid file index " << index << " in zip file "
-            << path_ << ".";
+    return v.capacity() * sizeof(T);
+}
+
+} // namespace
+
+std::size_t Reader::RecordList::memoryUsage() const
+{
+    return (paths_.capacity()
+            + vectorMemory(pathOffsets_)
+            + vectorMemory(headerStart_)
+            + vectorMemory(compressedSize_)
+            + vectorMemory(uncompressedSize_)
+            + vectorMemory(crc32_)
+            + vectorMemory(attributes_)
+            + vectorMemory(flag_)
+            + vectorMemory(compressionMethod_)
+            + vectorMemory(filenameSize_)
+            + vectorMemory(fileExtraSize_));
+}
+
+std::size_t Reader::memoryUsage() const
+{
+    return (sizeof(*this) + records_.memoryUsage()
+            + vectorMemory(pathIndex_) + vectorMemory(sortedIndex_));
+}
+
+namespace {
+
+/** FNV-1a hash of path string.
+ */
+inline std::size_t hashPath(boost::string_ref path)
+{
+    std::uint64_t hash(0xcbf29ce484222325ull);
+    for (unsigned char c : path) {
+        hash ^= c;
+        hash *= 0x100000001b3ull;
     }
+    return hash;
+}
 
-    // grab record
-    const auto &record(records_[index]);
+/** Returns smallest power of two that can hold given number of records with
+ *  load factor at most 1/2.
+ */
+inline std::size_t pathIndexSize(std::size_t count)
+{
+    std::size_t size(16);
+    while (size < (2 * count)) { size <<= 1; }
+    return size;
+}
 
-    // load minimal version of files header
-    MinimalFileHeader header;
-    {
-        std::size_t headerStart(record.headerStart);
-        std::size_t headerEnd(headerStart + localFileHeaderSize
-                              + maxFilenameSize + maxExtraSize);
-        if (headerEnd > fileLength_) { headerEnd = fileLength_; }
+} // namespace
 
-        boost::iostreams::stream<utility::io::SubStreamDevice> hf
-            (utility::io::SubStreamDevice
-             (path_, utility::io::SubStreamDevice::Filedes
-              { int(fd_), headerStart, headerEnd }), 512);
+void Reader::buildIndex()
+{
+    // hashed index
+    pathIndex_.assign(pathIndexSize(records_.size()), 0);
+    const auto mask(pathIndex_.size() - 1);
+
+    for (std::size_t i(0), e(records_.size()); i != e; ++i) {
+        const auto path(records_.pathString(i));
+        for (auto slot(hashPath(path) & mask); ; slot = (slot + 1) & mask) {
+            auto &item(pathIndex_[slot]);
+            if (!item) {
+                item = i + 1;
+                break;
+            }
 
-        header.read(hf);
-        updateHeader(header, record.header);
+            // duplicate path -> first one wins
+            if (records_.pathString(item - 1) == path) { break; }
+        }
     }
 
-    bool seekable(false);
-    std::size_t safetyPadding(0);
+    // sorted index
+    sortedIndex_.resize(records_.size());
+    for (std::size_t i(0), e(records_.size()); i != e; ++i) {
+        sortedIndex_[i] = i;
+    }
 
-    // add decompressor based on compression method
-    switch (const auto cm
-            = static_cast<CompressionMethod>(header.compressionMethod))
+    std::stable_sort(sortedIndex_.begin(), sortedIndex_.end()
+                     , [&](std::size_t l, std::size_t r)
     {
-    case CompressionMethod::store:
-        // not compressed, no decompressor needed
-        seekable = true;
-        break;
+        return records_.pathString(l) < records_.pathString(r);
+    });
+}
 
-    case CompressionMethod::bzip2:
-        fis.push(bio::bzip2_decompressor());
-        break;
+boost::optional<std::size_t>
+Reader::find(const boost::filesystem::path &path, std::nothrow_t) const
+{
+    if (pathIndex_.empty()) { return boost::none; }
 
-    case CompressionMethod::deflate:
-    case CompressionMethod::deflate64:
-        fis.push(bio::zlib_decompressor(DeflateParams));
-        safetyPadding = 16;
-        break;
+    const auto &key(path.string());
+    const auto mask(pathIndex_.size() - 1);
 
-    default:
-        LOGTHROW(err2, Error)
-            << "Unsupported compression method <" << cm << "> for file "
-            << record.path << " in the zip file "
-            << path_ << ".";
+    for (auto slot(hashPath(key) & mask); ; slot = (slot + 1) & mask) {
+        const auto item(pathIndex_[slot]);
+        if (!item) { return boost::none; }
+        if (records_.pathString(item - 1) == key) { return item - 1; }
     }
+}
 
-    const std::size_t fileStart(record.headerStart + header.size());
-    const std::size_t fileEnd(fileStart + header.compressedSize
-                              + safetyPadding);
+std::size_t Reader::find(const boost::filesystem::path &path) const
+{
+    if (const auto index = find(path, std::nothrow)) { return *index; }
 
-    // and finally push the device for the underlying compressed file
-    fis.push(utility::io::SubStreamDevice
-             (record.path, utility::io::SubStreamDevice::Filedes
-              { int(fd_), fileStart, fileEnd}));
+    LOGTHROW(err2, Error)
+        << "File " << path << " not found in zip file "
+        << path_ << ".";
+    throw;
+}
 
-    return PluggedFile(record.path, header.uncompressedSize, seekable);
+bool Reader::has(const boost::filesystem::path &path) const
+{
+    return bool(find(path, std::nothrow));
 }
 
-struct Writer::Detail : public std::enable_shared_from_this<Detail>
+std::vector<std::size_t>
+Reader::list(const boost::filesystem::path &directory, bool recursive) const
 {
-    typedef std::shared_ptr<Detail> pointer;
+    auto prefix(directory.string());
+    if (!prefix.empty() && (prefix.back() != '/')) { prefix.push_back('/'); }
 
-    Detail(const boost::filesystem::path &path, bool overwrite);
-    Detail(const boost::filesystem::path &path, const EmbedFlag&);
+    // find first path not less than prefix
+    auto isorted(std::lower_bound
+                 (sortedIndex_.begin(), sortedIndex_.end(), prefix
+                  , [&](std::size_t index, const std::string &prefix)
+    {
+        return records_.pathString(index) < prefix;
+    }));
+
+    std::vector<std::size_t> out;
+    for (auto esorted(sortedIndex_.end()); isorted != esorted; ++isorted) {
+        const auto path(records_.pathString(*isorted));
+        if (!path.starts_with(prefix)) {
+            // past the prefix
+            break;
+        }
 
-    ~Detail() {
-        if (fd) {
-            LOG(warn2) << "ZIP file " << fd.path() << " was not flushed. "
-                       << "Use close() member function.";
+        // skip directory itself
+        if (path.size() == prefix.size()) { continue; }
+
+        if (!recursive) {
+            // only direct children: no slash inside the rest of the path
+            // (slash at the very end marks directory)
+            const auto slash(path.substr(prefix.size()).find('/'));
+            if ((slash != boost::string_ref::npos)
+                && (prefix.size() + slash + 1 != path.size()))
+            {
+                continue;
+            }
         }
+
+        out.push_back(*isorted);
     }
 
-    OStream::pointer ostream(const boost::filesystem::path &path
-                             , Compression compression
-                             , const FilterInit &filterInit);
+    return out;
+}
 
-    void close();
+namespace {
 
-    void begin(const std::string &name);
+/** Reads exactly size bytes from given file offset.
+ */
+void readAll(const Filedes &fd, char *data, std::size_t size
+             , std::size_t offset)
+{
+    while (size) {
+        const auto bytes(TEMP_FAILURE_RETRY
+                         (::pread(fd, data, size, offset)));
+        if (bytes == -1) {
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Cannot read from file " << fd.path() << ": <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
 
-    struct FileEntry {
-        fs::path name;
-        CompressionMethod compressionMethod;
-        std::size_t compressedSize;
-        std::size_t uncompressedSize;
-        std::uint32_t crc32;
-        std::uint32_t attributes = Attributes::regular;
+        if (!bytes) {
+            LOGTHROW(err2, Error)
+                << "Unexpected end of file " << fd.path() << ".";
+        }
+
+        data += bytes;
+        size -= bytes;
+        offset += bytes;
+    }
+}
+
+#if UTILITY_HAS_ZLIB
+
+/** Files up to this uncompressed size are inflated by Reader::read() in one
+ *  go from whole compressed data.
+ */
+const std::size_t OneShotLimit(1 << 20);
+
+/** Raw inflate state with its input buffer. Reusable between files.
+ */
+struct InflateState : boost::noncopyable {
+    ::z_stream z;
+    std::vector<char> input;
+
+    InflateState() : input(1 << 14) {
+        std::memset(&z, 0, sizeof(z));
+        if (::inflateInit2(&z, -MAX_WBITS) != Z_OK) {
+            LOGTHROW(err2, Error) << "Cannot initialize inflate state.";
+        }
+    }
+
+    ~InflateState() { ::inflateEnd(&z); }
+};
+
+/** Per-thread pool of inflate states. States are handed out in shared
+ *  pointers that return the state to the pool of the releasing thread.
+ */
+class InflatePool : boost::noncopyable {
+public:
+    typedef std::shared_ptr<InflateState> pointer;
+
+    /** Get (reset) inflate state from this thread's pool.
+     */
+    static pointer acquire();
+
+    ~InflatePool() { destroyed_ = true; }
+
+private:
+    static InflatePool& instance() {
+        thread_local InflatePool pool;
+        return pool;
+    }
+
+    static void release(InflateState *state);
+
+    /** Maximum number of idle states kept per thread.
+     */
+    static constexpr std::size_t Limit = 4;
+
+    std::vector<std::unique_ptr<InflateState>> states_;
+
+    /** Pool destroyed at thread exit, states must not be returned anymore.
+     */
+    static thread_local bool destroyed_;
+};
+
+thread_local bool InflatePool::destroyed_(false);
+
+InflatePool::pointer InflatePool::acquire()
+{
+    std::unique_ptr<InflateState> state;
+
+    if (!destroyed_) {
+        auto &states(instance().states_);
+        if (!states.empty()) {
+            state = std::move(states.back());
+            states.pop_back();
+            ::inflateReset(&state->z);
+            // reset doesn't touch input, drop any leftover
+            state->z.next_in = nullptr;
+            state->z.avail_in = 0;
+        }
+    }
+
+    if (!state) { state.reset(new InflateState()); }
+
+    return pointer(state.release(), &InflatePool::release);
+}
+
+void InflatePool::release(InflateState *state)
+{
+    std::unique_ptr<InflateState> holder(state);
+    if (destroyed_) { return; }
+
+    auto &states(instance().states_);
+    if (states.size() < Limit) { states.push_back(std::move(holder)); }
+}
+
+/** Raw inflate input filter using pooled inflate state. Drop-in replacement
+ *  of bio::zlib_decompressor for ZIP files.
+ */
+class PooledInflater : public bio::multichar_input_filter {
+public:
+    PooledInflater() : state_(InflatePool::acquire()), done_() {}
+
+    template<typename Source>
+    std::streamsize read(Source &src, char_type *s, std::streamsize n) {
+        if (done_) { return -1; }
+
+        auto &z(state_->z);
+        auto &input(state_->input);
+        z.next_out = reinterpret_cast<Bytef*>(s);
+        z.avail_out = n;
+
+        while (z.avail_out) {
+            bool eof(false);
+            if (!z.avail_in) {
+                const auto bytes(bio::read(src, input.data(), input.size()));
+                // inflate may still have pending output even without input
+                eof = (bytes <= 0);
+                z.next_in = reinterpret_cast<Bytef*>(input.data());
+                z.avail_in = eof ? 0 : bytes;
+            }
+
+            const auto res(::inflate(&z, Z_NO_FLUSH));
+            if (res == Z_STREAM_END) {
+                done_ = true;
+                break;
+            }
+            if ((res == Z_BUF_ERROR) && eof) {
+                LOGTHROW(err2, Error)
+                    << "Unexpected end of deflate stream.";
+            }
+            if ((res != Z_OK) && (res != Z_BUF_ERROR)) {
+                LOGTHROW(err2, Error)
+                    << "Inflate failed: " << (z.msg ? z.msg : "unknown error")
+                    << ".";
+            }
+        }
+
+        const std::streamsize produced(n - z.avail_out);
+        return (!produced && done_) ? -1 : produced;
+    }
+
+private:
+    InflatePool::pointer state_;
+    bool done_;
+};
+
+#endif // UTILITY_HAS_ZLIB
+
+} // namespace
+
+PluggedFile Reader::plug(std::size_t index
+                         , boost::iostreams::filtering_istream &fis)
+    const
+{
+    if (index >= records_.size())  {
+        LOGTHROW(err2, Error)
+            << "Invalid file index " << index << " in zip file "
+            << path_ << ".";
+    }
+
+    // grab record
+    const auto &record(records_[index]);
+
+    // load minimal version of files header
+    const auto header(localHeader(record));
+
+    bool seekable(false);
+    std::size_t safetyPadding(0);
+
+    // add decompressor based on compression method
+    switch (const auto cm
+            = static_cast<CompressionMethod>(header.compressionMethod))
+    {
+    case CompressionMethod::store:
+        // not compressed, no decompressor needed
+        seekable = true;
+        break;
+
+    case CompressionMethod::bzip2:
+        fis.push(bio::bzip2_decompressor());
+        break;
+
+    case CompressionMethod::deflate:
+#if UTILITY_HAS_ZLIB
+        if (auto si = seekIndex(index, std::nothrow)) {
+            // seek index available, inflate from nearest checkpoint
+            fis.push(InflateIndex::Device
+                     (si, compressedSource(record, header)));
+            return PluggedFile(record.path(), header.uncompressedSize, true);
+        }
+
+        // reuse inflate state
+        fis.push(PooledInflater());
+        break;
+#else
+        // fall through
+#endif
+
+    case CompressionMethod::deflate64:
+        fis.push(bio::zlib_decompressor(DeflateParams));
+        safetyPadding = 16;
+        break;
+
+#if UTILITY_HAS_ZSTD
+    case CompressionMethod::zstd:
+    case CompressionMethod::zstdDeprecated:
+        fis.push(bio::zstd_decompressor());
+        break;
+#endif
+
+    default:
+        LOGTHROW(err2, Error)
+            << "Unsupported compression method <" << cm << "> for file "
+            << record.path() << " in the zip file "
+            << path_ << ".";
+    }
+
+    const std::size_t fileStart(record.headerStart + header.size());
+    const std::size_t fileEnd(fileStart + header.compressedSize
+                              + safetyPadding);
+
+    // and finally push the device for the underlying compressed file
+    if (memory_.data) {
+        // memory mapped or in-memory archive
+        const auto data(memory_.data);
+        fis.push(bio::array_source
+                 (data + std::min(fileStart, fileLength_)
+                  , data + std::min(fileEnd, fileLength_)));
+    } else {
+        fis.push(utility::io::SubStreamDevice
+                 (record.path(), utility::io::SubStreamDevice::Filedes
+                  { int(fd_), fileStart, fileEnd}
+                  , blockCache_, blockCacheKey_));
+    }
+
+    return PluggedFile(record.path(), header.uncompressedSize, seekable);
+}
+
+Reader::View Reader::view(std::size_t index) const
+{
+    if (index >= records_.size())  {
+        LOGTHROW(err2, Error)
+            << "Invalid file index " << index << " in zip file "
+            << path_ << ".";
+    }
+
+    if (!memory_.data) {
+        LOGTHROW(err2, Error)
+            << "Cannot get view of file at index " << index
+            << " in zip file " << path_ << ": archive is not in memory.";
+    }
+
+    const auto &record(records_[index]);
+    const auto header(localHeader(record));
+
+    const auto cm(static_cast<CompressionMethod>(header.compressionMethod));
+    if (cm != CompressionMethod::store) {
+        LOGTHROW(err2, Error)
+            << "Cannot get view of file " << record.path()
+            << " in zip file " << path_ << ": compression method <"
+            << cm << "> is not store.";
+    }
+
+    const std::size_t fileStart(record.headerStart + header.size());
+    if ((fileStart > fileLength_)
+        || (header.compressedSize > (fileLength_ - fileStart)))
+    {
+        LOGTHROW(err2, Error)
+            << "File " << record.path() << " lies past the end of zip file "
+            << path_ << ".";
+    }
+
+    return View(memory_.data + fileStart, header.compressedSize
+                , memory_.owner);
+}
+
+std::vector<char> Reader::read(std::size_t index) const
+{
+    if (index >= records_.size())  {
+        LOGTHROW(err2, Error)
+            << "Invalid file index " << index << " in zip file "
+            << path_ << ".";
+    }
+
+    const auto &record(records_[index]);
+    const auto header(localHeader(record));
+    const auto cm(static_cast<CompressionMethod>(header.compressionMethod));
+
+    const std::size_t fileStart(record.headerStart + header.size());
+    if ((fileStart > fileLength_)
+        || (header.compressedSize > (fileLength_ - fileStart)))
+    {
+        LOGTHROW(err2, Error)
+            << "File " << record.path() << " lies past the end of zip file "
+            << path_ << ".";
+    }
+
+    std::vector<char> out(header.uncompressedSize);
+
+    if ((cm == CompressionMethod::store)
+        && (header.compressedSize == header.uncompressedSize))
+    {
+        if (memory_.data) {
+            std::copy(memory_.data + fileStart
+                      , memory_.data + fileStart + out.size(), out.data());
+        } else {
+            readAll(fd_, out.data(), out.size(), fileStart);
+        }
+        return out;
+    }
+
+#if UTILITY_HAS_ZLIB
+    if ((cm == CompressionMethod::deflate)
+        && (header.uncompressedSize <= OneShotLimit)
+        && (header.compressedSize <= OneShotLimit))
+    {
+        // whole compressed data at once
+        std::vector<char> buffer;
+        const char *data(memory_.data ? (memory_.data + fileStart) : nullptr);
+        if (!data) {
+            buffer.resize(header.compressedSize);
+            readAll(fd_, buffer.data(), buffer.size(), fileStart);
+            data = buffer.data();
+        }
+
+        // inflate in one go
+        char dummy;
+        auto state(InflatePool::acquire());
+        auto &z(state->z);
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+        z.avail_in = header.compressedSize;
+        z.next_out = reinterpret_cast<Bytef*>(out.empty() ? &dummy
+                                              : out.data());
+        z.avail_out = out.size();
+
+        if ((::inflate(&z, Z_FINISH) != Z_STREAM_END) || z.avail_out) {
+            LOGTHROW(err2, Error)
+                << "Cannot inflate file " << record.path()
+                << " in zip file " << path_ << ".";
+        }
+        return out;
+    }
+#endif
+
+    // generic path
+    bio::filtering_istream fis;
+    plug(index, fis);
+    fis.exceptions(std::ios::badbit);
+    fis.read(out.data(), out.size());
+    if (std::size_t(fis.gcount()) != out.size()) {
+        LOGTHROW(err2, Error)
+            << "Unexpected end of file " << record.path()
+            << " in zip file " << path_ << ".";
+    }
+
+    return out;
+}
+
+#if UTILITY_HAS_ZLIB
+
+struct Reader::SeekIndices {
+    std::mutex mutex;
+    std::map<std::size_t, InflateIndex::pointer> indices;
+};
+
+namespace {
+
+const char SeekIndexMagic[8] = { 'Z', 'I', 'P', 'S', 'I', 'D', 'X', '2' };
+
+} // namespace
+
+InflateIndex::Source
+Reader::compressedSource(const Record &record
+                         , const detail::MinimalFileHeader &header) const
+{
+    const std::size_t fileStart(record.headerStart + header.size());
+    if ((fileStart > fileLength_)
+        || (header.compressedSize > (fileLength_ - fileStart)))
+    {
+        LOGTHROW(err2, Error)
+            << "File " << record.path() << " lies past the end of zip file "
+            << path_ << ".";
+    }
+
+    if (memory_.data) {
+        return InflateIndex::source(memory_.data + fileStart
+                                    , header.compressedSize, memory_.owner);
+    }
+
+    return InflateIndex::source(fd_, fileStart
+                                , fileStart + header.compressedSize);
+}
+
+InflateIndex::pointer Reader::seekIndex(std::size_t index
+                                        , std::size_t span) const
+{
+    if (index >= records_.size())  {
+        LOGTHROW(err2, Error)
+            << "Invalid file index " << index << " in zip file "
+            << path_ << ".";
+    }
+
+    if (auto si = seekIndex(index, std::nothrow)) { return si; }
+
+    const auto record(records_[index]);
+    const auto header(localHeader(record));
+
+    const auto cm(static_cast<CompressionMethod>(header.compressionMethod));
+    if (cm != CompressionMethod::deflate) {
+        LOGTHROW(err2, Error)
+            << "Cannot build seek index of file " << record.path()
+            << " in zip file " << path_ << ": compression method <"
+            << cm << "> is not deflate.";
+    }
+
+    InflateIndex::pointer si;
+    try {
+        si = InflateIndex::build(compressedSource(record, header)
+                                 , InflateIndex::Format::raw, span);
+    } catch (const std::runtime_error &e) {
+        LOGTHROW(err2, Error)
+            << "Cannot build seek index of file " << record.path()
+            << " in zip file " << path_ << ": " << e.what();
+    }
+
+    if (si->size() != header.uncompressedSize) {
+        LOGTHROW(err2, Error)
+            << "Cannot build seek index of file " << record.path()
+            << " in zip file " << path_ << ": inflated size "
+            << si->size() << " differs from recorded size "
+            << header.uncompressedSize << ".";
+    }
+
+    // first one wins
+    std::lock_guard<std::mutex> lock(seekIndices_->mutex);
+    return seekIndices_->indices.insert({ index, si }).first->second;
+}
+
+InflateIndex::pointer Reader::seekIndex(std::size_t index, std::nothrow_t)
+    const
+{
+    std::lock_guard<std::mutex> lock(seekIndices_->mutex);
+    auto &indices(seekIndices_->indices);
+    const auto fi(indices.find(index));
+    return (fi == indices.end()) ? InflateIndex::pointer() : fi->second;
+}
+
+fs::path Reader::seekIndexPath() const
+{
+    return path_.string() + ".zidx";
+}
+
+void Reader::saveSeekIndex(const fs::path &path) const
+{
+    std::map<std::size_t, InflateIndex::pointer> indices;
+    {
+        std::lock_guard<std::mutex> lock(seekIndices_->mutex);
+        indices = seekIndices_->indices;
+    }
+
+    if (!fd_) {
+        LOGTHROW(err2, Error)
+            << "Cannot save seek index of zip file " << path_
+            << ": archive is not backed by a file.";
+    }
+
+    const auto key(FileKey::from(fd_));
+
+    try {
+        writeFileAtomically(path, [&](std::ostream &f)
+        {
+            utility::detail::writeSidecarHeader(f, SeekIndexMagic, key);
+            bin::write(f, std::uint64_t(indices.size()));
+
+            for (const auto &item : indices) {
+                const auto record(records_[item.first]);
+                bin::write(f, std::uint64_t(item.first));
+                bin::write(f, std::uint64_t(record.headerStart));
+                bin::write(f, std::uint64_t(record.header.compressedSize));
+                bin::write(f, std::uint64_t(record.header.uncompressedSize));
+                item.second->save(f);
+            }
+        });
+    } catch (const std::exception &e) {
+        LOGTHROW(err2, Error)
+            << "Cannot save seek index of zip file " << path_
+            << " to " << path << ": " << e.what();
+    }
+}
+
+bool Reader::loadSeekIndex(const fs::path &path) const
+{
+    // cannot validate index without file
+    if (!fd_) { return false; }
+
+    std::ifstream f;
+    f.open(path.string(), std::ios_base::in | std::ios_base::binary);
+    if (!f) { return false; }
+
+    std::map<std::size_t, InflateIndex::pointer> indices;
+    try {
+        if (!utility::detail::readSidecarHeader
+            (f, SeekIndexMagic, FileKey::from(fd_), path, "zip seek index"))
+        {
+            return false;
+        }
+
+        auto count(bin::read<std::uint64_t>(f));
+        while (f && count--) {
+            const auto index(bin::read<std::uint64_t>(f));
+            const auto headerStart(bin::read<std::uint64_t>(f));
+            const auto compressedSize(bin::read<std::uint64_t>(f));
+            const auto uncompressedSize(bin::read<std::uint64_t>(f));
+            if (!f) { break; }
+
+            if (index >= records_.size()) { return false; }
+            const auto record(records_[index]);
+            if ((record.headerStart != headerStart)
+                || (record.header.compressedSize != compressedSize)
+                || (record.header.uncompressedSize != uncompressedSize))
+            {
+                LOG(info2) << "Seek index " << path
+                           << " doesn't match zip file " << path_ << ".";
+                return false;
+            }
+
+            auto si(InflateIndex::load(f));
+            if (si->size() != uncompressedSize) { return false; }
+            indices[index] = std::move(si);
+        }
+
+        if (!f) {
+            LOG(warn2) << "Seek index " << path << " is truncated.";
+            return false;
+        }
+    } catch (const std::exception &e) {
+        LOG(warn2) << "Cannot load seek index " << path << ": " << e.what();
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(seekIndices_->mutex);
+    for (auto &item : indices) {
+        seekIndices_->indices[item.first] = std::move(item.second);
+    }
+    return true;
+}
+
+#endif // UTILITY_HAS_ZLIB
+
+namespace {
+
+std::vector<std::size_t> allIndices(std::size_t count)
+{
+    std::vector<std::size_t> indices(count);
+    for (std::size_t i(0); i != count; ++i) { indices[i] = i; }
+    return indices;
+}
+
+/** Path of extracted file relative to destination directory, used to detect
+ *  files listed more than once.
+ */
+std::string destinationKey(const Reader::Record &record)
+{
+    std::string key;
+    for (const auto &component : record.path().relative_path()) {
+        if (component.empty() || (component == ".")) { continue; }
+        key.append(component.string()).push_back('/');
+    }
+    return key;
+}
+
+void extractFile(const Reader::Record &record, std::istream &is
+                 , const fs::path &destination)
+{
+    // make path relative, reject any attempt to escape destination
+    const auto relative(record.path().relative_path());
+    for (const auto &component : relative) {
+        if (component == "..") {
+            LOGTHROW(err2, Error)
+                << "Refusing to extract file " << record.path()
+                << " outside of destination directory " << destination
+                << ".";
+        }
+    }
+
+    const auto path(destination / relative);
+    const auto name(record.pathString());
+    if (!name.empty() && (name.back() == '/')) {
+        // directory
+        fs::create_directories(path);
+        return;
+    }
+
+    fs::create_directories(path.parent_path());
+
+    std::ofstream os;
+    os.exceptions(std::ios::badbit | std::ios::failbit);
+    os.open(path.string(), std::ios_base::out | std::ios_base::trunc
+            | std::ios_base::binary);
+    if (record.header.uncompressedSize) { os << is.rdbuf(); }
+    os.close();
+}
+
+} // namespace
+
+void Reader::extract(const std::vector<std::size_t> &indices
+                     , const ExtractSink &sink, std::size_t threads) const
+{
+    for (const auto index : indices) {
+        if (index >= records_.size())  {
+            LOGTHROW(err2, Error)
+                << "Invalid file index " << index << " in zip file "
+                << path_ << ".";
+        }
+    }
+
+    parallelFor(indices.size(), threads, [&](std::size_t i) -> void
+    {
+        const auto record(records_[indices[i]]);
+
+        bio::filtering_istream fis;
+        plug(record.index, fis);
+        fis.exceptions(std::ios::badbit | std::ios::failbit);
+
+        sink(record, fis);
+    });
+}
+
+void Reader::extract(const ExtractSink &sink, std::size_t threads) const
+{
+    extract(allIndices(records_.size()), sink, threads);
+}
+
+void Reader::extract(const std::vector<std::size_t> &indices
+                     , const fs::path &destination
+                     , std::size_t threads) const
+{
+    // file listed more than once would be written by multiple threads at
+    // once: keep only its first occurrence, same as find()
+    std::vector<std::size_t> unique;
+    unique.reserve(indices.size());
+    {
+        std::unordered_set<std::string> seen;
+        for (const auto index : indices) {
+            // invalid index is kept to be reported by extract() below
+            if ((index >= records_.size())
+                || seen.insert(destinationKey(records_[index])).second)
+            {
+                unique.push_back(index);
+            }
+        }
+    }
+
+    extract(unique, [&](const Record &record, std::istream &is)
+    {
+        extractFile(record, is, destination);
+    }, threads);
+}
+
+void Reader::extract(const fs::path &destination, std::size_t threads) const
+{
+    extract(allIndices(records_.size()), destination, threads);
+}
+
+Reader::VerifyReport Reader::verify(const std::vector<std::size_t> &indices
+                                    , std::size_t threads) const
+{
+    for (const auto index : indices) {
+        if (index >= records_.size())  {
+            LOGTHROW(err2, Error)
+                << "Invalid file index " << index << " in zip file "
+                << path_ << ".";
+        }
+    }
+
+    VerifyReport report;
+    report.results.reserve(indices.size());
+    for (const auto index : indices) { report.results.emplace_back(index); }
+
+    const auto start(std::chrono::steady_clock::now());
+
+    parallelFor(indices.size(), threads, [&](std::size_t i) -> void
+    {
+        auto &result(report.results[i]);
+        const auto record(records_[result.index]);
+        const auto &header(record.header);
+
+        if (header.flag & FlagEncrypted) {
+            result.error = "encrypted file cannot be verified";
+            return;
+        }
+
+        try {
+            bio::filtering_istream fis;
+            plug(record.index, fis);
+            fis.exceptions(std::ios::badbit);
+
+            Crc32 crc;
+            std::vector<char> buffer(1 << 16);
+            while (fis) {
+                fis.read(buffer.data(), buffer.size());
+                const auto bytes(fis.gcount());
+                crc.process_bytes(buffer.data(), bytes);
+                result.size += bytes;
+            }
+            result.crc32 = crc.checksum();
+        } catch (const std::exception &e) {
+            result.error = e.what();
+            return;
+        }
+
+        if (result.size != header.uncompressedSize) {
+            result.error = "size mismatch";
+        } else if (result.crc32 != header.crc32) {
+            result.error = "CRC-32 mismatch";
+        } else {
+            result.ok = true;
+        }
+    });
+
+    report.seconds = std::chrono::duration<double>
+        (std::chrono::steady_clock::now() - start).count();
+
+    for (const auto &result : report.results) {
+        const auto &header(records_[result.index].header);
+        report.compressedBytes += header.compressedSize;
+        report.uncompressedBytes += result.size;
+        if (!result.ok) {
+            LOG(warn2) << "File " << records_[result.index].path()
+                       << " in zip file " << path_ << " is corrupted: "
+                       << result.error << ".";
+            ++report.failed;
+        }
+    }
+
+    return report;
+}
+
+Reader::VerifyReport Reader::verify(std::size_t threads) const
+{
+    return verify(allIndices(records_.size()), threads);
+}
+
+MinimalFileHeader Reader::localHeader(const Record &record) const
+{
+    MinimalFileHeader header;
+
+    std::size_t headerStart(record.headerStart);
+    std::size_t headerEnd(headerStart + localFileHeaderSize
+                          + maxFilenameSize + maxExtraSize);
+    if (headerEnd > fileLength_) { headerEnd = fileLength_; }
+
+    if (memory_.data) {
+        if (headerStart > headerEnd) { headerStart = headerEnd; }
+        const auto data(memory_.data);
+        bio::stream<bio::array_source> hf
+            (data + headerStart, data + headerEnd);
+        header.read(hf);
+    } else {
+        bio::stream<utility::io::SubStreamDevice> hf
+            (utility::io::SubStreamDevice
+             (path_, utility::io::SubStreamDevice::Filedes
+              { int(fd_), headerStart, headerEnd }
+              , blockCache_, blockCacheKey_), 512);
+        header.read(hf);
+    }
+
+    updateHeader(header, record.header);
+    return header;
+}
+
+namespace detail {
+
+/** Writes whole buffer to file at its current position.
+ */
+void writeAll(const Filedes &fd, const char *data, std::size_t size)
+{
+    while (size) {
+        const auto written(TEMP_FAILURE_RETRY(::write(fd, data, size)));
+        if (written == -1) {
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Cannot write to file " << fd.path() << ": <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+        data += written;
+        size -= written;
+    }
+}
+
+/** Output sink holding data in memory until given threshold is reached. Then
+ *  everything is spilled into an unlinked temporary file.
+ */
+class SpillBuffer {
+public:
+    typedef char char_type;
+    typedef bio::sink_tag category;
+
+    SpillBuffer(const fs::path &dir, std::size_t threshold)
+        : dir_(dir.empty() ? fs::path(".") : dir), threshold_(threshold)
+        , size_()
+    {}
+
+    std::streamsize write(const char *data, std::streamsize size);
+
+    /** Number of bytes written so far.
+     */
+    std::size_t size() const { return size_; }
+
+    /** Appends whole content to given file at its current position.
+     */
+    void copyTo(const Filedes &fd) const;
+
+private:
+    /** Moves everything from memory to temporary file.
+     */
+    void spill();
+
+    const fs::path dir_;
+    const std::size_t threshold_;
+    std::vector<char> memory_;
+    Filedes file_;
+    std::size_t size_;
+};
+
+std::streamsize SpillBuffer::write(const char *data, std::streamsize size)
+{
+    if (!file_ && ((memory_.size() + size) > threshold_)) { spill(); }
+
+    if (file_) {
+        writeAll(file_, data, size);
+    } else {
+        memory_.insert(memory_.end(), data, data + size);
+    }
+
+    size_ += size;
+    return size;
+}
+
+void SpillBuffer::spill()
+{
+#ifdef O_TMPFILE
+    Filedes fd(::open(dir_.string().c_str(), O_TMPFILE | O_RDWR
+                      , S_IRUSR | S_IWUSR), dir_);
+    if (!fd && (errno == EISDIR || errno == EOPNOTSUPP)) {
+        // O_TMPFILE not supported by filesystem
+#else
+    Filedes fd;
+    {
+#endif
+        auto tmp((dir_ / ".zip-spill-XXXXXX").string());
+        fd = Filedes(::mkstemp(&tmp[0]), tmp);
+        if (fd) { ::unlink(tmp.c_str()); }
+    }
+
+    if (!fd) {
+        std::system_error e(errno, std::system_category());
+        LOG(err2) << "Cannot create temporary file in " << dir_ << ": <"
+                  << e.code() << ", " << e.what() << ">.";
+        throw e;
+    }
+
+    writeAll(fd, memory_.data(), memory_.size());
+    std::vector<char>().swap(memory_);
+    file_ = std::move(fd);
+}
+
+void SpillBuffer::copyTo(const Filedes &fd) const
+{
+    if (!file_) {
+        writeAll(fd, memory_.data(), memory_.size());
+        return;
+    }
+
+    std::vector<char> buffer(1 << 20);
+    for (std::size_t off(0); off < size_; ) {
+        const auto bytes(TEMP_FAILURE_RETRY
+                         (::pread(file_, buffer.data(), buffer.size(), off)));
+        if (bytes == -1) {
+            std::system_error e(errno, std::system_category());
+            LOG(err2) << "Cannot read from temporary file: <"
+                      << e.code() << ", " << e.what() << ">.";
+            throw e;
+        }
+        if (!bytes) {
+            LOGTHROW(err2, Error)
+                << "Temporary file is shorter than expected.";
+        }
+        writeAll(fd, buffer.data(), bytes);
+        off += bytes;
+    }
+}
+
+} // namespace detail
+
+struct Writer::Detail : public std::enable_shared_from_this<Detail>
+{
+    typedef std::shared_ptr<Detail> pointer;
+
+    Detail(const boost::filesystem::path &path, bool overwrite);
+    Detail(const boost::filesystem::path &path, const EmbedFlag&);
+
+    ~Detail() {
+        if (fd) {
+            LOG(warn2) << "ZIP file " << fd.path() << " was not flushed. "
+                       << "Use close() member function.";
+        }
+    }
+
+    OStream::pointer ostream(const boost::filesystem::path &path
+                             , Compression compression
+                             , const FilterInit &filterInit, int level);
+
+    void close();
+
+    void begin(const std::string &name);
+
+    struct FileEntry {
+        fs::path name;
+        CompressionMethod compressionMethod;
+        std::size_t compressedSize;
+        std::size_t uncompressedSize;
+        std::uint32_t crc32;
+        std::uint32_t attributes = Attributes::regular;
+        std::uint16_t flag = 0;
+
+        /** Version needed and DOS date/time of entry copied verbatim from
+         *  another archive. Otherwise fileHeader() derives version from
+         *  compression method and uses current time.
+         */
+        bool copied = false;
+        std::uint16_t versionNeeded = 0;
+        std::uint16_t modificationTime = 0;
+        std::uint16_t modificationDate = 0;
 
         FileEntry(const fs::path &name, CompressionMethod compressionMethod)
             : name(name), compressionMethod(compressionMethod)
@@ -980,6 +2329,30 @@ struct Writer::Detail : public std::enable_shared_from_this<Detail>
 
     void rollback();
 
+    /** Builds central directory file header for given entry placed at given
+     *  offset.
+     */
+    static CentralDirectoryFileHeader fileHeader(const FileEntry &fe
+                                                 , std::size_t offset);
+
+    /** Adds file header into the directory, replaces header with the same
+     *  filename if any.
+     */
+    void addToDirectory(const CentralDirectoryFileHeader &fh);
+
+    /** Writes file data at the current position of the archive file.
+     */
+    typedef std::function<void(const Filedes &fd)> DataWriter;
+
+    /** Appends finished file to the archive. File data are written by given
+     *  function. Used in concurrent mode and by addFile().
+     */
+    void append(const FileEntry &fileEntry, const DataWriter &data);
+
+    /** Adds existing file as a stored entry. Data are copied by the kernel.
+     */
+    void addFile(const fs::path &path, const fs::path &archivePath);
+
     void seekTo(std::size_t off) {
         auto res(::lseek(fd, off, SEEK_SET));
         if (res == -1) {
@@ -1034,6 +2407,18 @@ struct Writer::Detail : public std::enable_shared_from_this<Detail>
     ::off_t tx;
 
     CentralDirectoryFileHeader::list directory;
+
+    /** Filename -> index in the directory.
+     */
+    std::unordered_map<std::string, std::size_t> directoryIndex;
+
+    /** Concurrent mode: spill threshold, zero means non-concurrent mode.
+     */
+    std::size_t spillThreshold;
+
+    /** Serializes access to the archive file in concurrent mode.
+     */
+    std::mutex mutex;
 };
 
 namespace {
@@ -1081,12 +2466,12 @@ Filedes openFile(const boost::filesystem::path &path, OpenMode openMode)
 } // namespace
 
 Writer::Detail::Detail(const boost::filesystem::path &path, bool overwrite)
-    : fd(openFile(path, openMode(overwrite))), tx(-1)
+    : fd(openFile(path, openMode(overwrite))), tx(-1), spillThreshold()
 {
 }
 
 Writer::Detail::Detail(const boost::filesystem::path &path, const EmbedFlag&)
-    : fd(openFile(path, OpenMode::append)), tx(-1)
+    : fd(openFile(path, OpenMode::append)), tx(-1), spillThreshold()
 {
     CentralDirectoryReader cdr(fd);
     if (!cdr.open(true)) {
@@ -1098,7 +2483,7 @@ Writer::Detail::Detail(const boost::filesystem::path &path, const EmbedFlag&)
     try {
         cdr.read([&](int, const CentralDirectoryFileHeader &cdfh) -> void
         {
-            directory.push_back(cdfh);
+            addToDirectory(cdfh);
         });
     } catch (const std::ios_base::failure &e) {
         LOGTHROW(err2, Error)
@@ -1115,6 +2500,18 @@ CompressionMethod compressionMethod(Compression compression)
     case Compression::store: return CompressionMethod::store;
     case Compression::deflate: return CompressionMethod::deflate;
     case Compression::bzip2: return CompressionMethod::bzip2;
+
+    case Compression::zstd:
+#if UTILITY_HAS_ZSTD
+        return CompressionMethod::zstd;
+#else
+        LOGTHROW(err2, Error)
+            << "Zstandard compression is not supported (not compiled in).";
+#endif
+
+    case Compression::automatic:
+        // decided per file by ZipStream
+        break;
     }
 
     LOGTHROW(err2, Error)
@@ -1156,107 +2553,306 @@ public:
     std::uint32_t checksum() const { return crc32_.checksum(); }
 
 private:
-    boost::crc_32_type crc32_;
+    utility::Crc32 crc32_;
 };
 
-class ZipStream : public Writer::OStream
+/** Compression::automatic: file sample is deflated by fast compression
+ *  level and file is deflated only if sample shrinks below this ratio.
+ */
+const double AutoCompressionRatio(0.9);
+
+/** Trial compression of sample. Returns compressed size.
+ */
+std::size_t trialCompress(const std::vector<char> &sample)
+{
+    if (sample.empty()) { return 0; }
+
+    CounterFilter counter;
+    bio::filtering_ostream fos;
+    auto params(InflateParams);
+    params.level = bio::zlib::best_speed;
+    fos.push(bio::zlib_compressor(params));
+    fos.push(boost::ref(counter));
+    fos.push(bio::null_sink());
+    fos.write(sample.data(), sample.size());
+    bio::close(fos);
+    return counter.count();
+}
+
+/** Common part of ZIP file output streams: filter chain computing CRC-32 and
+ *  sizes and compressing the data. Derived class provides data sink and
+ *  finishes the file.
+ */
+class ZipStreamBase : public Writer::OStream
 {
 public:
-    ZipStream(Writer::Detail::pointer detail, const fs::path &name
-              , Compression compression, const Writer::FilterInit &filterInit)
-        : detail_(std::move(detail))
-        , fileEntry_(name, compressionMethod(compression))
-    {
-        detail_->begin(fileEntry_.name.generic_string());
-        open_ = true;
+    ZipStreamBase(const fs::path &name, Compression compression, int level)
+        : fileEntry_(name, compressionMethod
+                     ((compression == Compression::automatic)
+                      ? Compression::store : compression))
+        , compression_(compression), level_(level), open_(true)
+        , sampler_(*this)
+    {}
+
+    virtual std::ostream& get() { return fos_; }
+
+    virtual Statistics close() {
+        if (!open_) { return {}; }
+        open_ = false;
+
+        // close output file
+        bio::close(fos_);
+        if (stats_.compression == Compression::automatic) {
+            // sampler has not decided yet, i.e. nothing has been written
+            sampler_.decide();
+        }
+        if (!output_.empty()) { bio::close(output_); }
+
+        fileEntry_.compressedSize = compressedSize_.count();
+        fileEntry_.uncompressedSize
+            = (uncompressedSize_
+               ? uncompressedSize_->count() : fileEntry_.compressedSize);
+        fileEntry_.crc32 = crc32_.checksum();
+
+        finish(fileEntry_);
+
+        stats_.compressedSize = fileEntry_.compressedSize;
+        stats_.uncompressedSize = fileEntry_.uncompressedSize;
+        return stats_;
+    }
+
+    virtual void setFileAttributes(std::uint32_t attributes) {
+        if (!open_) {
+            LOGTHROW(err2, Error)
+                << "Zip stream for file " << fileEntry_.name
+                << " is already closed. Cannot udpate.";
+        }
+
+        fileEntry_.attributes = attributes;
+    }
 
+protected:
+    /** Builds filter chain. Must be called from derived class constructor.
+     */
+    void init(const Writer::FilterInit &filterInit) {
         if (filterInit) { filterInit(fos_); }
 
+        if (compression_ == Compression::automatic) {
+            // compression is decided by sampler, real output is opened later
+            stats_.compression = Compression::automatic;
+            fos_.push(boost::ref(sampler_));
+            fos_.push(bio::null_sink());
+            return;
+        }
+
+        open(fos_, compression_);
+    }
+
+    /** Closes stream, logs any error. To be called from derived class
+     *  destructor.
+     */
+    void closeQuietly() {
+        try {
+            close();
+        } catch (const std::exception &e) {
+            LOG(warn2) << "Uncaught exception in ZipStream flush: <"
+                       << e.what() << ">.";
+        } catch (...) {
+            LOG(warn2) << "Unknowmn uncaught exception in ZipStream flush.";
+        }
+    }
+
+    /** Called once compression method is known, before any data are
+     *  written.
+     */
+    virtual void opening(const Writer::Detail::FileEntry&) {}
+
+    /** Pushes data sink at the end of filter chain.
+     */
+    virtual void pushSink(bio::filtering_ostream &fos) = 0;
+
+    /** Finishes file, called from close().
+     */
+    virtual void finish(const Writer::Detail::FileEntry &fileEntry) = 0;
+
+    Writer::Detail::FileEntry fileEntry_;
+
+private:
+    /** Buffers sample of data, decides compression and then forwards all
+     *  data to the real output.
+     */
+    class Sampler : public bio::multichar_output_filter {
+    public:
+        Sampler(ZipStreamBase &zs) : zs_(zs), decided_() {}
+
+        template<typename Sink>
+        std::streamsize write(Sink&, const char_type *s, std::streamsize n)
+        {
+            if (decided_) {
+                zs_.output_.write(s, n);
+                return n;
+            }
+
+            sample_.insert(sample_.end(), s, s + n);
+            if (sample_.size() >= Writer::AutoSampleSize) { decide(); }
+            return n;
+        }
+
+        template<typename Sink>
+        void close(Sink&) { decide(); }
+
+        void decide() {
+            if (decided_) { return; }
+            decided_ = true;
+
+            auto &stats(zs_.stats_);
+            stats.sampleSize = sample_.size();
+            stats.sampleCompressedSize = trialCompress(sample_);
+
+            const auto compression
+                ((stats.sampleCompressedSize
+                  < AutoCompressionRatio * stats.sampleSize)
+                 ? Compression::deflate : Compression::store);
+
+            zs_.fileEntry_.compressionMethod = compressionMethod(compression);
+            zs_.open(zs_.output_, compression);
+            zs_.output_.exceptions(std::ios::badbit | std::ios::failbit);
+            zs_.output_.write(sample_.data(), sample_.size());
+
+            std::vector<char>().swap(sample_);
+        }
+
+    private:
+        ZipStreamBase &zs_;
+        bool decided_;
+        std::vector<char> sample_;
+    };
+
+    /** Pushes compressor and the rest of output chain into given stream.
+     */
+    void open(bio::filtering_ostream &fos, Compression compression) {
+        stats_.compression = compression;
+        opening(fileEntry_);
+
         // compute crc32 for uncompressed file
-        fos_.push(boost::ref(crc32_));
+        fos.push(boost::ref(crc32_));
 
         switch (compression) {
         case Compression::store:
+        case Compression::automatic:
             // do not touch
             break;
 
-        case Compression::deflate:
+        case Compression::deflate: {
             // measure uncompressed size
             uncompressedSize_ = boost::in_place();
-            fos_.push(boost::ref(*uncompressedSize_));
+            fos.push(boost::ref(*uncompressedSize_));
             // compress
-            fos_.push(bio::zlib_compressor(InflateParams));
-            break;
+            auto params(InflateParams);
+            if (level_ != Writer::DefaultLevel) { params.level = level_; }
+            fos.push(bio::zlib_compressor(params));
+            break; }
 
         case Compression::bzip2:
             // measure uncompressed size
             uncompressedSize_ = boost::in_place();
-            fos_.push(boost::ref(*uncompressedSize_));
+            fos.push(boost::ref(*uncompressedSize_));
             // compress
-            fos_.push(bio::bzip2_compressor());
+            fos.push(bio::bzip2_compressor
+                     ((level_ == Writer::DefaultLevel)
+                      ? bio::bzip2::default_block_size : level_));
             break;
-        }
-
-        // measure compressed size
-        fos_.push(boost::ref(compressedSize_));
-        // sink to file
-        fos_.push(bio::file_descriptor_sink
-                   (detail_->fd.get()
-                    , bio::file_descriptor_flags::never_close_handle));
-    }
 
-    virtual ~ZipStream() {
-        try {
-            close();
-        } catch (const std::exception &e) {
-            LOG(warn2) << "Uncaught exception in ZipStream flush: <"
-                       << e.what() << ">.";
-        } catch (...) {
-            LOG(warn2) << "Unknowmn uncaught exception in ZipStream flush.";
+        case Compression::zstd:
+#if UTILITY_HAS_ZSTD
+            // measure uncompressed size
+            uncompressedSize_ = boost::in_place();
+            fos.push(boost::ref(*uncompressedSize_));
+            // compress
+            fos.push(bio::zstd_compressor
+                     ((level_ == Writer::DefaultLevel)
+                      ? bio::zstd::default_compression : level_));
+#endif
+            break;
         }
+
+        // measure compressed size
+        fos.push(boost::ref(compressedSize_));
+        // and finally sink
+        pushSink(fos);
     }
 
-    virtual std::ostream& get() { return fos_; }
+    const Compression compression_;
+    const int level_;
 
-    virtual Statistics close() {
-        if (!open_) { return {}; }
-        open_ = false;
+    bool open_;
+    bio::filtering_ostream fos_;
 
-        // close output file
-        bio::close(fos_);
+    /** Compression::automatic only: sampler and real output stream.
+     */
+    Sampler sampler_;
+    bio::filtering_ostream output_;
 
-        fileEntry_.compressedSize = compressedSize_.count();
-        fileEntry_.uncompressedSize
-            = (uncompressedSize_
-               ? uncompressedSize_->count() : fileEntry_.compressedSize);
-        fileEntry_.crc32 = crc32_.checksum();
+    CounterFilter compressedSize_;
+    boost::optional<CounterFilter> uncompressedSize_;
+    Crc32Filter crc32_;
+
+    Statistics stats_;
+};
 
-        detail_->commit(fileEntry_);
+/** Output stream of file in (seekable) archive file.
+ */
+class ZipStream : public ZipStreamBase
+{
+public:
+    ZipStream(Writer::Detail::pointer detail, const fs::path &name
+              , Compression compression, const Writer::FilterInit &filterInit
+              , int level)
+        : ZipStreamBase(name, compression, level)
+        , detail_(std::move(detail))
+    {
+        if (detail_->spillThreshold) {
+            // concurrent mode, write into own buffer
+            spill_ = boost::in_place(detail_->fd.path().parent_path()
+                                     , detail_->spillThreshold);
+        } else {
+            detail_->begin(fileEntry_.name.generic_string());
+        }
 
-        return Statistics(fileEntry_.compressedSize
-                          , fileEntry_.uncompressedSize);
+        init(filterInit);
     }
 
-    virtual void setFileAttributes(std::uint32_t attributes) {
-        if (!open_) {
-            LOGTHROW(err2, Error)
-                << "Zip stream for file " << fileEntry_.name
-                << " is already closed. Cannot udpate.";
+    virtual ~ZipStream() { closeQuietly(); }
+
+private:
+    virtual void pushSink(bio::filtering_ostream &fos) {
+        // sink to buffer or directly to file
+        if (spill_) {
+            fos.push(boost::ref(*spill_));
+        } else {
+            fos.push(bio::file_descriptor_sink
+                     (detail_->fd.get()
+                      , bio::file_descriptor_flags::never_close_handle));
         }
+    }
 
-        fileEntry_.attributes = attributes;
+    virtual void finish(const Writer::Detail::FileEntry &fileEntry) {
+        if (spill_) {
+            const auto &spill(*spill_);
+            detail_->append(fileEntry, [&spill](const Filedes &fd)
+            {
+                spill.copyTo(fd);
+            });
+        } else {
+            detail_->commit(fileEntry);
+        }
     }
 
-private:
     Writer::Detail::pointer detail_;
-    Writer::Detail::FileEntry fileEntry_;
-
-    bool open_;
-    bio::filtering_ostream fos_;
 
-    CounterFilter compressedSize_;
-    boost::optional<CounterFilter> uncompressedSize_;
-    Crc32Filter crc32_;
+    /** Data buffer, used only in concurrent mode.
+     */
+    boost::optional<SpillBuffer> spill_;
 };
 
 const auto extra64SizeLocalHeader
@@ -1406,10 +3002,33 @@ void writeCentralHeader(std::ostream &os, const CentralDirectoryFileHeader &fh)
     bin::write(os, fh.fileComment.data(), fh.fileComment.size());
 }
 
+/** Writes ZIP64 end of central directory record, its locator and end of
+ *  central directory record.
+ */
+void writeEndOfCentralDirectory(std::ostream &os, std::size_t count
+                                , std::uint64_t cdOff, std::uint64_t eocdOff)
+{
+    // write 64bit end of central directory record
+    EndOfCentralDirectoryRecord eocd;
+    eocd.numberOfThisDisk = 0;
+    eocd.diskWhereCentralDirectoryStarts = 0;
+    eocd.numberOfCentralDirectoryRecordsOnThisDisk = count;
+    eocd.totalNumberOfCentralDirectoryRecords = count;
+    eocd.sizeOfCentralDirectory = (eocdOff - cdOff);
+    eocd.centralDirectoryOffset = cdOff;
+    eocd.write64(os);
+
+    // write 64bit end of central directory locator
+    EndOfCentralDirectory64Locator::writeSimple(os, eocdOff);
+
+    // write end of central directory record
+    eocd.write64Marker(os);
+}
+
 Writer::OStream::pointer
 Writer::Detail::ostream(const boost::filesystem::path &path
                         , Compression compression
-                        , const FilterInit &filterInit)
+                        , const FilterInit &filterInit, int level)
 {
     if (!fd) {
         LOGTHROW(err2, Error)
@@ -1417,7 +3036,7 @@ Writer::Detail::ostream(const boost::filesystem::path &path
     }
 
     auto os(std::make_shared<ZipStream>
-            (shared_from_this(), path, compression, filterInit));
+            (shared_from_this(), path, compression, filterInit, level));
     os->get().exceptions(std::ios::badbit | std::ios::failbit);
     return os;
 }
@@ -1441,19 +3060,7 @@ void Writer::Detail::commit(const FileEntry &fe)
             << "Not inside a transaction.";
     }
 
-    CentralDirectoryFileHeader fh;
-
-    fh.versionNeeded = VERSION_NEEDED;
-    fh.versionMadeBy = VERSION_MADE_BY;
-    fh.compressionMethod = static_cast<decltype(fh.compressionMethod)>
-        (fe.compressionMethod);
-    std::tie(fh.modificationDate, fh.modificationTime) = msDateTime();
-    fh.crc32 = fe.crc32;
-    fh.compressedSize = fe.compressedSize;
-    fh.uncompressedSize = fe.uncompressedSize;
-    fh.externalFileAttributes = fe.attributes;
-    fh.filename = fe.name.generic_string();
-    fh.fileOffset = tx;
+    const auto fh(fileHeader(fe, tx));
 
     try {
         // write a file header
@@ -1473,21 +3080,91 @@ void Writer::Detail::commit(const FileEntry &fe)
         throw;
     }
 
+    addToDirectory(fh);
+
+    tx = -1;
+}
+
+CentralDirectoryFileHeader
+Writer::Detail::fileHeader(const FileEntry &fe, std::size_t offset)
+{
+    CentralDirectoryFileHeader fh;
+
+    if (fe.copied) {
+        fh.versionNeeded = fe.versionNeeded;
+        fh.modificationTime = fe.modificationTime;
+        fh.modificationDate = fe.modificationDate;
+    } else {
+        fh.versionNeeded = ((fe.compressionMethod == CompressionMethod::zstd)
+                            ? VERSION_NEEDED_ZSTD : VERSION_NEEDED);
+        std::tie(fh.modificationDate, fh.modificationTime) = msDateTime();
+    }
+    fh.versionMadeBy = VERSION_MADE_BY;
+    fh.compressionMethod = static_cast<decltype(fh.compressionMethod)>
+        (fe.compressionMethod);
+    fh.crc32 = fe.crc32;
+    fh.compressedSize = fe.compressedSize;
+    fh.uncompressedSize = fe.uncompressedSize;
+    fh.externalFileAttributes = fe.attributes;
+    fh.filename = fe.name.generic_string();
+    fh.fileOffset = offset;
+    fh.flag = fe.flag;
+
+    return fh;
+}
+
+void Writer::Detail::addToDirectory(const CentralDirectoryFileHeader &fh)
+{
     // try to find a record with the same path
-    auto fdirectory(std::find_if(directory.begin(), directory.end()
-                                 , [&](const CentralDirectoryFileHeader &h)
-                                 {
-                                     return (h.filename == fh.filename);
-                                 }));
+    const auto res(directoryIndex.insert
+                   (std::make_pair(fh.filename, directory.size())));
 
-    if (fdirectory == directory.end()) {
+    if (res.second) {
         // not found, append
         directory.push_back(fh);
     } else {
         // found, replace
-        *fdirectory = fh;
+        directory[res.first->second] = fh;
+    }
+}
+
+void Writer::Detail::append(const FileEntry &fe, const DataWriter &data)
+{
+    std::unique_lock<std::mutex> lock(mutex);
+
+    if (!fd) {
+        LOGTHROW(err2, Error)
+            << "ZIP archive " << fd.path() << " is closed.";
+    }
+
+    if (tx >= 0) {
+        LOGTHROW(err2, Error)
+            << "Cannot write more than one file to a ZIP archive at once.";
+    }
+
+    // start transaction at the end of file
+    tx = seekEnd();
+
+    const auto fh(fileHeader(fe, tx));
+
+    try {
+        {
+            bio::stream<bio::file_descriptor_sink> os
+                (fd.get(), bio::file_descriptor_flags::never_close_handle);
+            os.exceptions(std::ios::badbit | std::ios::failbit);
+            writeLocalHeader(os, fh);
+            bio::close(os);
+        }
+        data(fd);
+    } catch (const std::exception &e) {
+        LOG(err2) << "Cannot append to a ZIP file " << fd.path()
+                  << "; rolling back.";
+        rollback();
+        throw;
     }
 
+    addToDirectory(fh);
+
     tx = -1;
 }
 
@@ -1512,6 +3189,8 @@ void Writer::Detail::rollback()
 
 void Writer::Detail::close()
 {
+    std::unique_lock<std::mutex> lock(mutex);
+
     if (!fd) { return; }
 
     // this ensures fd is closed even if tail write fails
@@ -1544,21 +3223,7 @@ void Writer::Detail::close()
             (fd.get(), bio::file_descriptor_flags::never_close_handle);
         os.exceptions(std::ios::badbit | std::ios::failbit);
 
-        // write 64bit end of central directory record
-        EndOfCentralDirectoryRecord eocd;
-        eocd.numberOfThisDisk = 0;
-        eocd.diskWhereCentralDirectoryStarts = 0;
-        eocd.numberOfCentralDirectoryRecordsOnThisDisk = directory.size();
-        eocd.totalNumberOfCentralDirectoryRecords = directory.size();
-        eocd.sizeOfCentralDirectory = (eocdOff - cdOff);
-        eocd.centralDirectoryOffset = cdOff;
-        eocd.write64(os);
-
-        // write 64bit end of central directory locator
-        EndOfCentralDirectory64Locator::writeSimple(os, eocdOff);
-
-        // write end of central directory record
-        eocd.write64Marker(os);
+        writeEndOfCentralDirectory(os, directory.size(), cdOff, eocdOff);
 
         bio::close(os);
     }
@@ -1580,11 +3245,360 @@ void Writer::close()
     return detail_->close();
 }
 
+void Writer::concurrent(std::size_t spillThreshold)
+{
+    auto &detail(*detail_);
+    if (detail.tx >= 0) {
+        LOGTHROW(err2, Error)
+            << "Cannot switch ZIP archive " << detail.fd.path()
+            << " to concurrent mode while a file is being written.";
+    }
+
+    detail.spillThreshold = std::max(spillThreshold, std::size_t(1));
+}
+
 Writer::OStream::pointer Writer::ostream(const boost::filesystem::path &path
                                          , Compression compression
-                                         , const FilterInit &filterInit)
+                                         , const FilterInit &filterInit
+                                         , int level)
+{
+    return detail_->ostream(path, compression, filterInit, level);
+}
+
+void Writer::Detail::addFile(const fs::path &path, const fs::path &archivePath)
+{
+    Filedes src(openFile(path));
+    const auto size(fileSize(src));
+
+    FileEntry fe(archivePath, CompressionMethod::store);
+    fe.compressedSize = fe.uncompressedSize = size;
+    fe.attributes = Attributes::fromFile(path);
+
+    // checksum from read-only mapping
+    if (size) {
+        MappedFile mapping(src, size);
+        mapping.advise(MappedFile::Advice::sequential);
+        fe.crc32 = utility::crc32(mapping.data(), size);
+    }
+
+    append(fe, [&](const Filedes &fd)
+    {
+        copyRange(src, 0, size, fd);
+    });
+}
+
+void Writer::copy(const Reader &reader, std::size_t index
+                  , const boost::filesystem::path &archivePath)
+{
+    if (index >= reader.records_.size())  {
+        LOGTHROW(err2, Error)
+            << "Invalid file index " << index << " in zip file "
+            << reader.path_ << ".";
+    }
+
+    const auto record(reader.records_[index]);
+    const auto header(reader.localHeader(record));
+
+    if (header.flag & (FlagEncrypted | FlagStrongEncryption)) {
+        LOGTHROW(err2, Error)
+            << "Cannot copy encrypted file " << record.path()
+            << " from zip file " << reader.path_ << ".";
+    }
+
+    const std::size_t fileStart(record.headerStart + header.size());
+    if ((fileStart > reader.fileLength_)
+        || (header.compressedSize > (reader.fileLength_ - fileStart)))
+    {
+        LOGTHROW(err2, Error)
+            << "File " << record.path() << " lies past the end of zip file "
+            << reader.path_ << ".";
+    }
+
+    Detail::FileEntry fe(archivePath.empty()
+                 ? record.path().relative_path() : archivePath
+                 , static_cast<CompressionMethod>(header.compressionMethod));
+    fe.compressedSize = header.compressedSize;
+    fe.uncompressedSize = header.uncompressedSize;
+    fe.crc32 = header.crc32;
+    fe.attributes = record.attributes;
+    // sizes are known upfront, no data descriptor
+    fe.flag = header.flag & ~FlagDataDescriptor;
+    fe.copied = true;
+    fe.versionNeeded = header.versionNeeded;
+    fe.modificationTime = header.modificationTime;
+    fe.modificationDate = header.modificationDate;
+
+    detail_->append(fe, [&](const Filedes &fd)
+    {
+        if (reader.memory_.data) {
+            writeAll(fd, reader.memory_.data + fileStart
+                     , header.compressedSize);
+        } else {
+            copyRange(reader.fd_, fileStart, header.compressedSize, fd);
+        }
+    });
+}
+
+void Writer::addFile(const boost::filesystem::path &path
+                     , const boost::filesystem::path &archivePath
+                     , Compression compression, int level)
+{
+    if (compression == Compression::store) {
+        detail_->addFile(path, archivePath);
+        return;
+    }
+
+    std::ifstream f;
+    f.exceptions(std::ios::badbit | std::ios::failbit);
+    f.open(path.string(), std::ios_base::in | std::ios_base::binary);
+
+    auto os(ostream(archivePath, compression, {}, level));
+    os->setFileAttributes(Attributes::fromFile(path));
+    if (f.peek() != std::ifstream::traits_type::eof()) {
+        os->get() << f.rdbuf();
+    }
+    os->close();
+}
+
+struct StreamWriter::Detail {
+    Detail(std::ostream &os)
+        : buffering(false), inFile(false), closed(false)
+    {
+        out.push(boost::ref(written));
+        out.push(os);
+        out.exceptions(std::ios::badbit | std::ios::failbit);
+    }
+
+    Detail(int fd)
+        : owned(boost::in_place
+                (fd, bio::file_descriptor_flags::never_close_handle))
+        , buffering(false), inFile(false), closed(false)
+    {
+        owned->exceptions(std::ios::badbit | std::ios::failbit);
+        out.push(boost::ref(written));
+        out.push(*owned);
+        out.exceptions(std::ios::badbit | std::ios::failbit);
+    }
+
+    /** Current position in the output, i.e. number of bytes written so far.
+     */
+    std::uint64_t position() {
+        out.flush();
+        return written.count();
+    }
+
+    void check() const {
+        if (closed) {
+            LOGTHROW(err2, Error) << "Streamed ZIP archive is closed.";
+        }
+    }
+
+    /** Starts new file. Local header of compressed file is written right
+     *  away, with unknown sizes and CRC. Stored file is buffered instead.
+     */
+    void begin(const Writer::Detail::FileEntry &fe) {
+        check();
+        if (inFile) {
+            LOGTHROW(err2, Error)
+                << "Cannot write more than one file to a ZIP archive "
+                "at once.";
+        }
+        inFile = true;
+
+        header = Writer::Detail::fileHeader(fe, position());
+        buffering = (fe.compressionMethod == CompressionMethod::store);
+        if (!buffering) { writeStreamedHeader(); }
+    }
+
+    /** Writes file data, buffers stored file until StoreBufferSize is
+     *  reached.
+     */
+    void write(const char *data, std::streamsize size) {
+        if (buffering) {
+            buffer.insert(buffer.end(), data, data + size);
+            if (buffer.size() <= StreamWriter::StoreBufferSize) { return; }
+
+            // too big, stream the rest
+            buffering = false;
+            writeStreamedHeader();
+            flushBuffer();
+            return;
+        }
+
+        out.write(data, size);
+    }
+
+    /** Writes data descriptor (or buffered stored file) and remembers file
+     *  for central directory.
+     */
+    void commit(const Writer::Detail::FileEntry &fe) {
+        header.crc32 = fe.crc32;
+        header.compressedSize = fe.compressedSize;
+        header.uncompressedSize = fe.uncompressedSize;
+        header.externalFileAttributes = fe.attributes;
+
+        if (buffering) {
+            // whole file is known, write it with real sizes
+            writeLocalHeader(out, header);
+            flushBuffer();
+            buffering = false;
+        } else {
+            // ZIP64 data descriptor since local header has ZIP64 extra field
+            bin::write(out, DATA_DESCRIPTOR_SIGNATURE);
+            bin::write(out, std::uint32_t(header.crc32));
+            bin::write(out, std::uint64_t(header.compressedSize));
+            bin::write(out, std::uint64_t(header.uncompressedSize));
+        }
+
+        directory.push_back(header);
+        inFile = false;
+    }
+
+    /** Writes local header with data descriptor flag, zero sizes and CRC.
+     */
+    void writeStreamedHeader() {
+        header.flag |= FlagDataDescriptor;
+        auto local(header);
+        local.crc32 = 0;
+        local.compressedSize = local.uncompressedSize = 0;
+        writeLocalHeader(out, local);
+    }
+
+    void flushBuffer() {
+        out.write(buffer.data(), buffer.size());
+        std::vector<char>().swap(buffer);
+    }
+
+    void close() {
+        if (closed) { return; }
+        if (inFile) {
+            LOGTHROW(err2, Error)
+                << "Cannot close streamed ZIP archive while a file is being "
+                "written.";
+        }
+
+        const auto cdOff(position());
+        for (const auto &fh : directory) { writeCentralHeader(out, fh); }
+        const auto eocdOff(position());
+
+        writeEndOfCentralDirectory(out, directory.size(), cdOff, eocdOff);
+        out.flush();
+        if (owned) { owned->flush(); }
+
+        closed = true;
+    }
+
+    boost::optional<bio::stream<bio::file_descriptor_sink>> owned;
+    bio::filtering_ostream out;
+    CounterFilter written;
+
+    CentralDirectoryFileHeader::list directory;
+
+    /** Header of current file.
+     */
+    CentralDirectoryFileHeader header;
+
+    /** Data of current stored file, see StreamWriter::StoreBufferSize.
+     */
+    std::vector<char> buffer;
+    bool buffering;
+
+    bool inFile;
+    bool closed;
+};
+
+namespace {
+
+/** Sink forwarding file data to streamed archive.
+ */
+class StreamedZipSink {
+public:
+    typedef char char_type;
+    typedef bio::sink_tag category;
+
+    StreamedZipSink(StreamWriter::Detail &detail) : detail_(&detail) {}
+
+    std::streamsize write(const char *s, std::streamsize n) {
+        detail_->write(s, n);
+        return n;
+    }
+
+private:
+    StreamWriter::Detail *detail_;
+};
+
+/** Output stream of file in streamed archive.
+ */
+class StreamedZipStream : public ZipStreamBase
+{
+public:
+    StreamedZipStream(const std::shared_ptr<StreamWriter::Detail> &detail
+                      , const fs::path &name
+                      , Compression compression
+                      , const Writer::FilterInit &filterInit
+                      , int level)
+        : ZipStreamBase(name, compression, level)
+        , detail_(detail)
+    {
+        detail_->check();
+        init(filterInit);
+    }
+
+    virtual ~StreamedZipStream() { closeQuietly(); }
+
+private:
+    virtual void opening(const Writer::Detail::FileEntry &fileEntry) {
+        detail_->begin(fileEntry);
+    }
+
+    virtual void pushSink(bio::filtering_ostream &fos) {
+        fos.push(StreamedZipSink(*detail_));
+    }
+
+    virtual void finish(const Writer::Detail::FileEntry &fileEntry) {
+        detail_->commit(fileEntry);
+    }
+
+    std::shared_ptr<StreamWriter::Detail> detail_;
+};
+
+} // namespace
+
+StreamWriter::StreamWriter(int fd)
+    : detail_(std::make_shared<Detail>(fd))
+{}
+
+StreamWriter::StreamWriter(std::ostream &os)
+    : detail_(std::make_shared<Detail>(os))
+{}
+
+StreamWriter::~StreamWriter()
+{
+    if (!detail_->closed) {
+        LOG(warn2) << "Streamed ZIP archive was not closed. "
+                   << "Use close() member function.";
+    }
+}
+
+Writer::OStream::pointer
+StreamWriter::ostream(const boost::filesystem::path &path
+                      , Compression compression
+                      , const Writer::FilterInit &filterInit, int level)
+{
+    auto os(std::make_shared<StreamedZipStream>
+            (detail_, path, compression, filterInit, level));
+    os->get().exceptions(std::ios::badbit | std::ios::failbit);
+    return os;
+}
+
+void StreamWriter::close()
+{
+    detail_->close();
+}
+
+std::uint64_t StreamWriter::size() const
 {
-    return detail_->ostream(path, compression, filterInit);
+    return detail_->position();
 }
 
 } } // namespace utility::zip
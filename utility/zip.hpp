@@ -39,11 +39,21 @@
 #include <vector>
 #include <limits>
 #include <memory>
+#include <new>
+#include <functional>
 
+#include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
+#include <boost/iterator/iterator_facade.hpp>
 #include <boost/filesystem/path.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 
 #include "filedes.hpp"
+#include "mappedfile.hpp"
+
+#if UTILITY_HAS_ZLIB
+#  include "inflate-index.hpp"
+#endif
 #include "substream.hpp"
 #include "enum-io.hpp"
 
@@ -73,14 +83,22 @@ namespace detail {
 struct MinimalFileHeader {
     std::uint16_t flag;
     std::uint16_t compressionMethod;
+    std::uint32_t crc32;
     std::uint64_t compressedSize;
     std::uint64_t uncompressedSize;
     std::uint16_t filenameSize;
     std::uint16_t fileExtraSize;
 
+    /** Filled in by read() only, i.e. valid for local headers.
+     */
+    std::uint16_t versionNeeded;
+    std::uint16_t modificationTime;
+    std::uint16_t modificationDate;
+
     MinimalFileHeader()
-        : flag(), compressionMethod(), compressedSize(), uncompressedSize()
-        , filenameSize(), fileExtraSize()
+        : flag(), compressionMethod(), crc32(), compressedSize()
+        , uncompressedSize(), filenameSize(), fileExtraSize()
+        , versionNeeded(), modificationTime(), modificationDate()
     {}
 
     void read(std::istream &in);
@@ -90,6 +108,28 @@ struct MinimalFileHeader {
 
 } // namespace detail
 
+/** ZIP reader options.
+ */
+struct ReaderOptions {
+    /** Limit number of files read into file list.
+     */
+    std::size_t limit = std::numeric_limits<std::size_t>::max();
+
+    /** Sanitize paths, see Reader::Reader for details.
+     */
+    bool sanitizePaths = true;
+
+    /** Map whole archive into memory. All data are then read from the mapping
+     *  and Reader::view() can be used.
+     */
+    bool mmap = false;
+
+    /** Read local headers and file data through given block cache (e.g.
+     *  io::BlockCache::process()). Not used in mmap mode.
+     */
+    io::BlockCache::pointer blockCache;
+};
+
 class Reader {
 public:
     /** Opens ZIP file.
@@ -112,42 +152,392 @@ public:
            , std::size_t limit = std::numeric_limits<std::size_t>::max()
            , bool sanitizePaths = true);
 
-    /** File record.
+    /** Opens ZIP file. Same as above, with full control via options.
+     */
+    Reader(const boost::filesystem::path &path, const ReaderOptions &options);
+
+    /** Opens ZIP archive from already open file descriptor, e.g. anonymous
+     *  memory file created by utility::memoryFile(). Reader takes ownership of
+     *  the descriptor (pass fd.dup() to keep own copy). Data are read by
+     *  positioned reads only, i.e. file position is left untouched.
+     */
+    Reader(Filedes &&fd, const ReaderOptions &options = ReaderOptions());
+
+    /** Opens ZIP archive held in memory. Nothing is copied: memory must stay
+     *  valid while the reader lives unless kept alive by memory.owner. Such
+     *  reader behaves as a memory mapped one (see mapped() and view()).
+     *  ReaderOptions::mmap is ignored.
+     */
+    Reader(const MemoryView &memory
+           , const ReaderOptions &options = ReaderOptions());
+
+    class RecordList;
+
+    /** File record. Lightweight view into reader's record storage.
      */
     class Record {
     public:
-        typedef std::vector<Record> list;
+        typedef RecordList list;
 
         std::size_t index;
-        boost::filesystem::path path;
         std::size_t headerStart;
         detail::MinimalFileHeader header;
 
-        Record(std::size_t index, const boost::filesystem::path &path
+        /** External file attributes from the central directory.
+         */
+        std::uint32_t attributes;
+
+        /** Path of file inside the archive.
+         */
+        boost::filesystem::path path() const {
+            return boost::filesystem::path(path_.begin(), path_.end());
+        }
+
+        /** Path of file inside the archive as a view into reader's path
+         *  storage. Valid as long as the reader lives.
+         */
+        boost::string_ref pathString() const { return path_; }
+
+        Record(std::size_t index, boost::string_ref path
                , std::size_t headerStart
-               , const detail::MinimalFileHeader &header)
-            : index(index), path(path), headerStart(headerStart)
-            , header(header)
+               , const detail::MinimalFileHeader &header
+               , std::uint32_t attributes = 0)
+            : index(index), headerStart(headerStart), header(header)
+            , attributes(attributes), path_(path)
         {}
 
+    private:
+        boost::string_ref path_;
     };
 
+    /** Compact list of file records. All paths live in single string arena,
+     *  header fields are stored as struct-of-arrays. Records are served as
+     *  views.
+     */
+    class RecordList {
+    public:
+        class const_iterator;
+        typedef const_iterator iterator;
+        typedef Record value_type;
+
+        RecordList() : pathOffsets_(1, 0) {}
+
+        std::size_t size() const { return headerStart_.size(); }
+        bool empty() const { return headerStart_.empty(); }
+
+        Record operator[](std::size_t index) const;
+
+        /** Path of index-th record, see Record::pathString().
+         */
+        boost::string_ref pathString(std::size_t index) const;
+
+        const_iterator begin() const;
+        const_iterator end() const;
+
+        void reserve(std::size_t size);
+
+        void push_back(const std::string &path, std::size_t headerStart
+                       , const detail::MinimalFileHeader &header
+                       , std::uint32_t attributes);
+
+        /** Releases any unused reserved memory.
+         */
+        void shrink_to_fit();
+
+        /** Heap memory occupied by this list, in bytes.
+         */
+        std::size_t memoryUsage() const;
+
+    private:
+        std::string paths_;
+        std::vector<std::uint64_t> pathOffsets_;
+        std::vector<std::uint64_t> headerStart_;
+        std::vector<std::uint64_t> compressedSize_;
+        std::vector<std::uint64_t> uncompressedSize_;
+        std::vector<std::uint32_t> crc32_;
+        std::vector<std::uint32_t> attributes_;
+        std::vector<std::uint16_t> flag_;
+        std::vector<std::uint16_t> compressionMethod_;
+        std::vector<std::uint16_t> filenameSize_;
+        std::vector<std::uint16_t> fileExtraSize_;
+    };
+
+    class RecordList::const_iterator
+        : public boost::iterator_facade<const_iterator, const Record
+                                        , boost::random_access_traversal_tag
+                                        , Record>
+    {
+    public:
+        const_iterator() : list_(), index_() {}
+
+    private:
+        friend class RecordList;
+        friend class boost::iterator_core_access;
+
+        const_iterator(const RecordList *list, std::size_t index)
+            : list_(list), index_(index)
+        {}
+
+        Record dereference() const { return (*list_)[index_]; }
+        bool equal(const const_iterator &o) const {
+            return index_ == o.index_;
+        }
+        void increment() { ++index_; }
+        void decrement() { --index_; }
+        void advance(std::ptrdiff_t n) { index_ += n; }
+        std::ptrdiff_t distance_to(const const_iterator &o) const {
+            return std::ptrdiff_t(o.index_) - std::ptrdiff_t(index_);
+        }
+
+        const RecordList *list_;
+        std::size_t index_;
+    };
+
+    /** List of all files in the archive. Records (and their paths) are views
+     *  into reader's storage and must not outlive the reader.
+     */
     const Record::list& files() const { return records_; }
 
+    /** Finds file by its path. Throws Error when not found.
+     *
+     *  Served by hashed path index built when archive is opened, i.e. lookup
+     *  doesn't depend on number of files in the archive.
+     *
+     *  When more files share the same path the first one (in central
+     *  directory order) wins; extract() follows the same rule.
+     */
     std::size_t find(const boost::filesystem::path &path) const;
 
+    /** Finds file by its path. Returns boost::none when not found.
+     */
+    boost::optional<std::size_t>
+    find(const boost::filesystem::path &path, std::nothrow_t) const;
+
+    /** Checks whether there is a file with given path in the archive.
+     */
+    bool has(const boost::filesystem::path &path) const;
+
+    /** Lists files inside given directory. Indices are returned in path
+     *  order.
+     *
+     * \param directory directory to list; archive root is "/" for sanitized
+     *                  paths and empty path otherwise
+     * \param recursive list whole subtree if true, only direct children
+     *                  otherwise
+     */
+    std::vector<std::size_t>
+    list(const boost::filesystem::path &directory
+         , bool recursive = true) const;
+
     /** Plug decompressing stream for file at given index at the end of the
      *  filtering_istream.
+     *
+     *  Plugged stream is seekable for stored files and for deflate compressed
+     *  files with available seek index (see seekIndex()).
+     *
+     *  Deflate decompressor reuses inflate state (including its window) from
+     *  per-thread pool, i.e. plugging many small files doesn't allocate and
+     *  initialize new zlib state each time.
      */
     PluggedFile plug(std::size_t index
                      , boost::iostreams::filtering_istream &fis) const;
 
+    /** Batch extraction sink. Called with decompressing stream of each
+     *  extracted file.
+     */
+    typedef std::function<void(const Record &record, std::istream &is)>
+        ExtractSink;
+
+    /** Extracts given files in parallel. Files are decompressed concurrently
+     *  on given number of worker threads sharing this reader's file
+     *  descriptor. The sink is called from the worker threads, i.e. it must
+     *  be thread safe.
+     *
+     *  First failure stops the extraction and is rethrown.
+     *
+     * \param indices indices of files to extract
+     * \param sink sink called for each file
+     * \param threads number of worker threads, 0 means number of CPUs
+     */
+    void extract(const std::vector<std::size_t> &indices
+                 , const ExtractSink &sink, std::size_t threads = 0) const;
+
+    /** Extracts all files in parallel. See above.
+     */
+    void extract(const ExtractSink &sink, std::size_t threads = 0) const;
+
+    /** Extracts given files in parallel into destination directory. Any
+     *  missing directory is created. Paths pointing outside of the
+     *  destination directory are rejected. When more files share the same
+     *  path the first one (in order of given indices) wins, see find().
+     */
+    void extract(const std::vector<std::size_t> &indices
+                 , const boost::filesystem::path &destination
+                 , std::size_t threads = 0) const;
+
+    /** Extracts all files in parallel into destination directory.
+     */
+    void extract(const boost::filesystem::path &destination
+                 , std::size_t threads = 0) const;
+
+    /** Result of verification of single file.
+     */
+    struct VerifyResult {
+        std::size_t index;
+
+        /** Data decompressed without error and both size and CRC-32 match
+         *  the archive.
+         */
+        bool ok;
+
+        /** Number of uncompressed bytes actually read.
+         */
+        std::uint64_t size;
+
+        /** CRC-32 of uncompressed data actually read.
+         */
+        std::uint32_t crc32;
+
+        /** Reason of failure, empty when ok.
+         */
+        std::string error;
+
+        VerifyResult(std::size_t index = 0)
+            : index(index), ok(false), size(), crc32()
+        {}
+    };
+
+    /** Verification report.
+     */
+    struct VerifyReport {
+        /** Per-file results, in the order of requested indices.
+         */
+        std::vector<VerifyResult> results;
+
+        /** Number of failed files.
+         */
+        std::size_t failed;
+
+        /** Total number of compressed bytes processed.
+         */
+        std::uint64_t compressedBytes;
+
+        /** Total number of uncompressed bytes produced.
+         */
+        std::uint64_t uncompressedBytes;
+
+        /** Wall clock duration of the whole verification.
+         */
+        double seconds;
+
+        VerifyReport()
+            : failed(), compressedBytes(), uncompressedBytes(), seconds()
+        {}
+
+        bool ok() const { return !failed; }
+
+        /** Uncompressed bytes per second.
+         */
+        double throughput() const {
+            return seconds ? (uncompressedBytes / seconds) : 0.0;
+        }
+    };
+
+    /** Verifies integrity of given files: files are decompressed in parallel
+     *  on given number of worker threads and checked against size and CRC-32
+     *  stored in the archive. Unlike extract(), failure of single file
+     *  doesn't stop the verification; it is reported in the result.
+     *
+     * \param indices indices of files to verify
+     * \param threads number of worker threads, 0 means number of CPUs
+     */
+    VerifyReport verify(const std::vector<std::size_t> &indices
+                        , std::size_t threads = 0) const;
+
+    /** Verifies integrity of all files. See above.
+     */
+    VerifyReport verify(std::size_t threads = 0) const;
+
+    /** Reads whole content of file at given index.
+     *
+     *  Small deflate compressed files are inflated in one go, from whole
+     *  compressed data into preallocated output, using inflate state from
+     *  per-thread pool (see plug()). Other files are read via plug().
+     */
+    std::vector<char> read(std::size_t index) const;
+
+    /** Contiguous read-only view of file content.
+     */
+    typedef MemoryView View;
+
+    /** Returns view of content of file at given index. Available only for
+     *  stored (i.e. uncompressed) files in a memory mapped (see
+     *  ReaderOptions::mmap) or in-memory archive. View keeps the memory alive
+     *  even when this reader is destroyed.
+     */
+    View view(std::size_t index) const;
+
+    /** Approximate heap memory occupied by parsed central directory and
+     *  lookup indices, in bytes. Memory mapping is not included.
+     */
+    std::size_t memoryUsage() const;
+
+    /** Is this archive memory mapped or held in memory?
+     */
+    bool mapped() const { return memory_.data != nullptr; }
+
+#if UTILITY_HAS_ZLIB
+    /** Returns seek index of deflate compressed file at given index. Index is
+     *  built on demand (i.e. whole file is inflated once) unless already
+     *  available. Once available, plug() provides seekable stream for this
+     *  file where any range is reached by inflating at most `span` bytes.
+     *
+     *  Thread safe.
+     *
+     * \param index file index
+     * \param span distance between checkpoints in uncompressed data
+     */
+    InflateIndex::pointer
+    seekIndex(std::size_t index
+              , std::size_t span = InflateIndex::DefaultSpan) const;
+
+    /** Returns seek index of file at given index if available (built or
+     *  loaded), null pointer otherwise.
+     */
+    InflateIndex::pointer seekIndex(std::size_t index, std::nothrow_t) const;
+
+    /** Default location of persisted seek indices: archive path with
+     *  ".zidx" appended.
+     */
+    boost::filesystem::path seekIndexPath() const;
+
+    /** Saves all available seek indices to given file.
+     */
+    void saveSeekIndex(const boost::filesystem::path &path) const;
+
+    /** Saves all available seek indices next to the archive.
+     */
+    void saveSeekIndex() const { saveSeekIndex(seekIndexPath()); }
+
+    /** Loads seek indices from given file. Returns false if there is no
+     *  such file or if it doesn't belong to this archive (different size or
+     *  modification time or different file layout).
+     */
+    bool loadSeekIndex(const boost::filesystem::path &path) const;
+
+    /** Loads seek indices from next to the archive. See above.
+     */
+    bool loadSeekIndex() const { return loadSeekIndex(seekIndexPath()); }
+#endif
+
     static bool check(const boost::filesystem::path &path);
 
 private:
+    friend class Writer;
+
     boost::filesystem::path path_;
 
-    /** Open file descriptor.
+    /** Open file descriptor, invalid for in-memory archive.
      */
     Filedes fd_;
 
@@ -155,9 +545,52 @@ private:
      */
     std::size_t fileLength_;
 
+    /** Whole archive in memory (mapping in mmap mode or memory given by
+     *  user), empty otherwise.
+     */
+    MemoryView memory_;
+
+    /** Block cache and archive identity, optional.
+     */
+    io::BlockCache::pointer blockCache_;
+    io::BlockCache::FileKey blockCacheKey_ = {};
+
     /** List of records.
      */
     Record::list records_;
+
+    /** Hashed path index: open addressing table of (record index + 1), zero
+     *  marks empty slot. Table size is always a power of two.
+     */
+    std::vector<std::size_t> pathIndex_;
+
+    /** Record indices sorted by path. Used for directory listing.
+     */
+    std::vector<std::size_t> sortedIndex_;
+
+    /** Reads central directory and builds indices. Common to all
+     *  constructors.
+     */
+    void open(const ReaderOptions &options);
+
+#if UTILITY_HAS_ZLIB
+    /** Available seek indices, shared by all threads.
+     */
+    struct SeekIndices;
+    std::shared_ptr<SeekIndices> seekIndices_;
+
+    /** Returns source of compressed data of given file.
+     */
+    InflateIndex::Source
+    compressedSource(const Record &record
+                     , const detail::MinimalFileHeader &header) const;
+#endif
+
+    void buildIndex();
+
+    /** Reads local file header of given record.
+     */
+    detail::MinimalFileHeader localHeader(const Record &record) const;
 };
 
 
@@ -170,10 +603,15 @@ struct Attributes {
     static std::uint32_t fromFile(const boost::filesystem::path &path);
 };
 
+/** Compression method of file written to archive. Compression::automatic
+ *  chooses between store and deflate per file, see Writer::ostream().
+ */
 UTILITY_GENERATE_ENUM(Compression,
                       ((store))
                       ((deflate))
                       ((bzip2))
+                      ((zstd))
+                      ((automatic)("auto"))
                       )
 
 struct EmbedFlag {};
@@ -203,6 +641,28 @@ public:
      */
     void close();
 
+    /** Default size of in-memory buffer in concurrent mode.
+     */
+    static constexpr std::size_t DefaultSpillThreshold = 64 << 20;
+
+    /** Switches writer into concurrent mode. Must be called before first
+     *  ostream() call.
+     *
+     *  In concurrent mode any number of ostreams can be open at once (even in
+     *  different threads). Each ostream compresses its data into its own
+     *  buffer which is spilled into an unlinked temporary file when it grows
+     *  over given threshold. Finished file is appended to the archive when its
+     *  ostream is closed, i.e. files are stored in commit order.
+     *
+     *  Writer doesn't spawn any threads: data are compressed in the threads
+     *  writing into the ostreams. Single-threaded producer therefore gets no
+     *  speed-up, files must be written from multiple threads (e.g. via
+     *  utility::parallelFor()).
+     *
+     * \param spillThreshold maximum size of in-memory buffer of one ostream
+     */
+    void concurrent(std::size_t spillThreshold = DefaultSpillThreshold);
+
     /** Output stream type. [fwd declarations]
      */
     class OStream;
@@ -210,17 +670,78 @@ public:
     typedef std::function<void(boost::iostreams::filtering_ostream&)
                           > FilterInit;
 
+    /** Use compressor's default compression level.
+     */
+    static constexpr int DefaultLevel = -1;
+
+    /** Size of data sampled by Compression::automatic.
+     */
+    static constexpr std::size_t AutoSampleSize = 64 << 10;
+
     /** Creates new ostream.
      *
      * Returned ostream must be closed by calling its close() function.
      *
+     * Only one ostream can be open at once unless the writer is in concurrent
+     * mode. Creating ostream in concurrent mode is thread safe.
+     *
+     * Compression::zstd is available only when compiled with zstd support
+     * (UTILITY_HAS_ZSTD), Error is thrown otherwise.
+     *
+     * Compression::automatic buffers first AutoSampleSize bytes of the file
+     * and trial-compresses them with fast deflate. File is deflated (with
+     * given level) only if the sample shrinks to less than 90 % of its size,
+     * otherwise it is stored. Decision is reported in OStream::Statistics.
+     *
      * \param path full file path inside the archive
      * \param compression requested compression method
+     * \param filterInit initializes stream filters in front of compressor
+     * \param level compression level: 1-9 for deflate and bzip2, 1-22 for
+     *              zstd; DefaultLevel means 9 for deflate and bzip2 and zstd's
+     *              own default
      */
     std::shared_ptr<OStream>
     ostream(const boost::filesystem::path &path
             , Compression compression = Compression::store
-            , const FilterInit &filterInit = FilterInit());
+            , const FilterInit &filterInit = FilterInit()
+            , int level = DefaultLevel);
+
+    /** Adds existing file to the archive.
+     *
+     *  Stored files take a fast path: CRC is computed from a read-only
+     *  mapping of the file and data are copied into the archive by the kernel
+     *  (copy_file_range/sendfile), i.e. no data pass through user space
+     *  streams. Other compression methods stream the file through ostream().
+     *
+     *  Thread safe in concurrent mode. In normal mode it must not be called
+     *  while an ostream is open.
+     *
+     * \param path path to file to add
+     * \param archivePath full file path inside the archive
+     * \param compression requested compression method
+     * \param level compression level, see ostream()
+     */
+    void addFile(const boost::filesystem::path &path
+                 , const boost::filesystem::path &archivePath
+                 , Compression compression = Compression::store
+                 , int level = DefaultLevel);
+
+    /** Copies file at given index from given archive into this archive
+     *  without recompression. Compressed data, compression method, CRC, sizes
+     *  and file attributes are copied verbatim; data are moved by the kernel
+     *  when possible. Encrypted files are not supported.
+     *
+     *  Thread safe in concurrent mode. In normal mode it must not be called
+     *  while an ostream is open.
+     *
+     * \param reader source archive
+     * \param index index of file in the source archive
+     * \param archivePath full file path inside this archive; empty path
+     *                    means the source path (made relative)
+     */
+    void copy(const Reader &reader, std::size_t index
+              , const boost::filesystem::path &archivePath
+              = boost::filesystem::path());
 
     /** Internals. [fwd declarations]
      */
@@ -240,10 +761,23 @@ public:
         std::size_t compressedSize;
         std::size_t uncompressedSize;
 
+        /** Compression actually used.
+         */
+        Compression compression;
+
+        /** Compression::automatic only: size of sampled data and size of
+         *  sample after trial compression. Zero otherwise.
+         */
+        std::size_t sampleSize;
+        std::size_t sampleCompressedSize;
+
         Statistics(std::size_t compressedSize = 0
-                   , std::size_t uncompressedSize = 0)
+                   , std::size_t uncompressedSize = 0
+                   , Compression compression = Compression::store)
             : compressedSize(compressedSize)
             , uncompressedSize(uncompressedSize)
+            , compression(compression)
+            , sampleSize(), sampleCompressedSize()
         {}
     };
 
@@ -257,6 +791,105 @@ public:
     virtual void setFileAttributes(std::uint32_t attributes) = 0;
 };
 
+/** Streaming ZIP writer for non-seekable outputs (pipes, sockets, HTTP
+ *  responses, ...).
+ *
+ *  Archive is written in one pass: each compressed file starts with local
+ *  header with data descriptor flag (bit 3) set and zero CRC and sizes (in
+ *  ZIP64 extra field), data follow and are terminated by ZIP64 data
+ *  descriptor holding the real values. Central directory is written by
+ *  close().
+ *
+ *  Many readers cannot find the end of stored data without sizes in the
+ *  local header, therefore stored files are buffered in memory and written
+ *  with real CRC and sizes and without data descriptor. Only stored files
+ *  larger than StoreBufferSize fall back to data descriptor.
+ *
+ *  Memory usage doesn't depend on file sizes (besides the store buffer),
+ *  only central directory entries are kept. Only one ostream can be open at
+ *  once; not thread safe.
+ */
+class StreamWriter {
+public:
+    /** Maximum size of stored file written without data descriptor.
+     */
+    static constexpr std::size_t StoreBufferSize = 1 << 20;
+
+    /** Writes archive to given file descriptor. Descriptor is not closed.
+     */
+    explicit StreamWriter(int fd);
+
+    /** Writes archive to given stream. Stream must outlive this writer and
+     *  all streams returned by ostream().
+     */
+    explicit StreamWriter(std::ostream &os);
+
+    /** Warns on non-closed archive.
+     */
+    ~StreamWriter();
+
+    /** Creates new ostream, see Writer::ostream(). Local header of
+     *  compressed file is written right away (Compression::automatic: once
+     *  compression is decided), stored file is written when closed or when
+     *  it outgrows StoreBufferSize.
+     */
+    Writer::OStream::pointer
+    ostream(const boost::filesystem::path &path
+            , Compression compression = Compression::store
+            , const Writer::FilterInit &filterInit = Writer::FilterInit()
+            , int level = Writer::DefaultLevel);
+
+    /** Writes central directory and flushes output. Must be called before
+     *  object destruction.
+     */
+    void close();
+
+    /** Number of bytes written so far.
+     */
+    std::uint64_t size() const;
+
+    /** Internals. [fwd declarations]
+     */
+    struct Detail;
+
+private:
+    std::shared_ptr<Detail> detail_;
+};
+
+// inlines
+
+inline Reader::Record Reader::RecordList::operator[](std::size_t index) const
+{
+    detail::MinimalFileHeader header;
+    header.flag = flag_[index];
+    header.compressionMethod = compressionMethod_[index];
+    header.compressedSize = compressedSize_[index];
+    header.uncompressedSize = uncompressedSize_[index];
+    header.crc32 = crc32_[index];
+    header.filenameSize = filenameSize_[index];
+    header.fileExtraSize = fileExtraSize_[index];
+    return Record(index, pathString(index), headerStart_[index], header
+                  , attributes_[index]);
+}
+
+inline boost::string_ref
+Reader::RecordList::pathString(std::size_t index) const
+{
+    const auto begin(pathOffsets_[index]);
+    return boost::string_ref(paths_.data() + begin
+                             , pathOffsets_[index + 1] - begin);
+}
+
+inline Reader::RecordList::const_iterator Reader::RecordList::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+inline Reader::RecordList::const_iterator Reader::RecordList::end() const
+{
+    return const_iterator(this, size());
+}
+
 } } // namespace utility::zip
 
 #endif // utility_zip_hpp_included_